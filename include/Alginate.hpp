@@ -35,8 +35,11 @@
 #include <cstdint>
 #include <cstddef>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
+struct RSAKey;
+
 class AlgInt
 {
     private:
@@ -73,6 +76,65 @@ class AlgInt
          */
         static void swap(AlgInt& first, AlgInt& second);
 
+    //! Public, so that chained products can classify their modulus once (see `mod_mul()`).
+    public:
+        // Reduction data for moduli of the form 2^k - c (defined below the class).
+        struct SpecialMod;
+
+        /**
+         * @brief Detects whether `m` is close enough to a power of two to be reduced by folding.
+         *
+         * @param sm The reduction data to fill in. Only valid if true is returned.
+         * @return true `m` has a special form, and `sm` may be passed to `mod_mul()`.
+         */
+        static bool special_mod(const AlgInt& m, SpecialMod& sm);
+
+    private:
+        /**
+         * @brief Reduces a non-negative `x` modulo the special-form modulus described by `sm`, in place.
+         */
+        static void special_redc(AlgInt& x, const SpecialMod& sm);
+
+        // Accumulated Euclid steps (defined below the class).
+        struct CofactorMatrix;
+
+        /**
+         * @brief Simulates Euclid's algorithm on the leading bits of `big` and `sml` (Lehmer's algorithm).
+         *
+         * @param big The larger operand, must not be below `sml`. Both operands must be non-negative.
+         * @param mat The accumulated steps. Only valid if true is returned.
+         * @param min_bits If non-zero, the simulation stops before `sml` would drop to `min_bits` bits or fewer.
+         * @param quotients If provided, the low byte of every simulated quotient is appended (in order).
+         * @return true At least one step was simulated, and `apply_matrix()` may be used.
+         * @return false The next quotient is too large to simulate, and a full division step is required.
+         */
+        static bool lehmer_matrix(const AlgInt& big, const AlgInt& sml, CofactorMatrix& mat, size_t min_bits = 0, std::vector<uint8_t>* quotients = nullptr);
+
+        /**
+         * @brief Performs (`big`, `sml`) = (a*`big` + b*`sml`, c*`big` + d*`sml`) in place, with a single pass over the digits.
+         *
+         * @note Both results must be non-negative, as is the case for the operands or the absolute cofactors of Euclid's algorithm
+         * (such as the rows of a `HalfGcdMatrix`, which grow by at most two digits).
+         */
+        static void apply_matrix(AlgInt& big, AlgInt& sml, const CofactorMatrix& mat);
+
+        // Product of Euclid steps with multi-precision entries (defined below the class).
+        struct HalfGcdMatrix;
+
+        /**
+         * @brief Performs Euclid steps on `a` >= `b` >= 0 in place, until `b` has about half the bits of `a` (half-gcd).
+         *
+         * @param mat If not nullptr, the performed steps, where (`a`, `b`) = `mat` * (`a'`, `b'`).
+         */
+        static void hgcd(AlgInt& a, AlgInt& b, HalfGcdMatrix* mat);
+
+        /**
+         * @brief Reduces `a` >= `b` >= 0 in place with `hgcd()`, until `b` has at most `digits` digits. gcd(`a`, `b`) is unchanged.
+         *
+         * @param mat If not nullptr, the performed steps are accumulated into `mat`, as in `hgcd()`.
+         */
+        static void hgcd_reduce(AlgInt& a, AlgInt& b, size_t digits, HalfGcdMatrix* mat);
+
 
     //! Temporary public. Used in mont_exp_timing.
     public:
@@ -355,9 +417,69 @@ class AlgInt
          * @param ret The AlgInt to store the result in. May overlap with `x`, `y`, or `m`.
          *
          * @exception std::domain_error Will throw if `m` == 0.
+         *
+         * @note Exponents of at most 64 bits (such as 65537) skip Montgomery setup and use Barrett reduction instead.
          */
         static void mod_exp(const AlgInt& x, const AlgInt& y, const AlgInt& m, AlgInt& ret);
 
+        /**
+         * @brief Perform `x[i]` ** `y[i]` % `m[i]` = `ret[i]` for every i, interleaving independent exponentiations across SIMD lanes.
+         *
+         * @param x The bases.
+         * @param y The exponents.
+         * @param m The moduli, must be odd and all have the same number of digits.
+         * @param ret The vector to store the results in. May overlap with `x`, `y`, or `m`.
+         *
+         * @note Throughput scales with the vector width the library was compiled for (see the ALGINATE_NATIVE CMake option).
+         *
+         * @exception std::domain_error Will throw if the vectors differ in length, any input is signed, or any `m` is even or has a different digit count.
+         */
+        static void mont_exp_batch(const std::vector<AlgInt>& x, const std::vector<AlgInt>& y, const std::vector<AlgInt>& m, std::vector<AlgInt>& ret);
+
+
+    //? Modular
+
+        /**
+         * @brief The shape of a modulus as detected by `classify_mod()`. Every form except `General`
+         * is written as `m` = 2^k - c, which allows reduction by shifts and additions alone.
+         */
+        enum class ModForm
+        {
+            General,        // No usable structure, reduced with division (or Montgomery).
+            Mersenne,       // c == 1
+            PseudoMersenne, // c has at most k/2 bits
+            Solinas,        // c is a sparse sum of signed powers of two
+        };
+
+        /**
+         * @brief Classifies the modulus `m` by its distance from the next power of two.
+         *
+         * @return The detected `ModForm`. Negative or small (single digit) moduli are always `General`.
+         *
+         * @note `mod_mul()` and `mod_exp()` perform this classification automatically.
+         */
+        static ModForm classify_mod(const AlgInt& m);
+
+        /**
+         * @brief Perform `x` * `y` % `m` = `ret`.
+         *
+         * @param ret The AlgInt to store the result in. May overlap with `x`, `y`, or `m`.
+         *
+         * @note Special-form moduli (see `ModForm`) are reduced without any division.
+         *
+         * @exception std::domain_error Will throw if `m` == 0.
+         */
+        static void mod_mul(const AlgInt& x, const AlgInt& y, const AlgInt& m, AlgInt& ret);
+
+        /**
+         * @brief Perform `x` * `y` % m = `ret`, for the special-form modulus m classified by `special_mod()`.
+         *
+         * @param ret The AlgInt to store the result in. May overlap with `x` or `y`.
+         *
+         * @exception std::domain_error Will throw if `sm` does not describe a special form.
+         */
+        static void mod_mul(const AlgInt& x, const AlgInt& y, const SpecialMod& sm, AlgInt& ret);
+
 
     //? Bitwise
 
@@ -425,6 +547,10 @@ class AlgInt
          * @brief Perform `gcd(a, b)` = `ret`. The gcd of two numbers `a` and `b` is the highest number that divides both numbers evenly. 
          * 
          * @param ret The AlgInt to store the result in. May overlap with `a` or `b`.
+         *
+         * @note Uses Lehmer's algorithm, which performs many Euclid steps per pass over the digits, until the operands are
+         * small enough for the (allocation-free) binary gcd to finish. Operands of hundreds of thousands of bits are first
+         * reduced with the subquadratic half-gcd. The result is always non-negative.
          */
         static void gcd(const AlgInt& a, const AlgInt& b, AlgInt& ret);
 
@@ -442,6 +568,103 @@ class AlgInt
          */
         static AlgInt lcm(const AlgInt& x, const AlgInt& y);
 
+        /**
+         * @brief Computes the Jacobi symbol (`a`/`n`), extended to even and negative `n` as the Kronecker symbol.
+         *
+         * @return 1 or -1 if gcd(`a`, `n`) == 1, and 0 otherwise. For an odd prime `n`, the result is 1 if `a` is a
+         * quadratic residue (mod `n`) and -1 if it is not.
+         *
+         * @note Large operands are reduced with Lehmer steps, and the final 64 bits use the binary algorithm.
+         */
+        static int jacobi(const AlgInt& a, const AlgInt& n);
+
+        /**
+         * @brief Perform floor(sqrt(`x`)) = `root` and `x` - `root`^2 = `rem`.
+         *
+         * @param x The non-negative AlgInt to find the square root of.
+         * @param root The AlgInt to store the square root in. May overlap with `x`.
+         * @param rem The AlgInt to store the remainder in (zero if `x` is a perfect square). May overlap with `x`.
+         *
+         * @note Newton's iteration, where each recursion level doubles the precision of the first approximation.
+         * @warning If the AlgInt for `root` equals the AlgInt for `rem`, the behavior is undefined.
+         *
+         * @exception std::domain_error Will be thrown if `x` is negative.
+         */
+        static void isqrt_rem(const AlgInt& x, AlgInt& root, AlgInt& rem);
+
+        /**
+         * @brief Perform floor(sqrt(`x`)) = `ret`.
+         *
+         * @param ret The AlgInt to store the result in. May overlap with `x`.
+         *
+         * @exception std::domain_error Will be thrown if `x` is negative.
+         */
+        static void isqrt(const AlgInt& x, AlgInt& ret);
+
+        /**
+         * @brief Perform the integer `k`-th root of `x` = `ret`, rounded toward zero.
+         *
+         * @param x The AlgInt to find the root of. May only be negative for an odd `k`.
+         * @param k The degree of the root.
+         * @param ret The AlgInt to store the result in. May overlap with `x`.
+         *
+         * @note Newton's iteration, where each recursion level doubles the precision of the first approximation.
+         *
+         * @exception std::domain_error Will be thrown if `k` is zero, or if `x` is negative and `k` is even.
+         */
+        static void iroot(const AlgInt& x, uint32_t k, AlgInt& ret);
+
+        /**
+         * @brief Determines whether `x` = `base`^`k` for some `k` >= 2.
+         *
+         * @param x The AlgInt to test.
+         * @param base The AlgInt to store the base in, which is not a perfect power itself (the largest `k` is found).
+         * Set to `x` if `x` is not a perfect power. May overlap with `x`.
+         * @param k The exponent, or 1 if `x` is not a perfect power.
+         * @return true `x` is a perfect power. 0 and 1 are reported as `x`^2, and -1 as (-1)^3.
+         * @return false `x` is not a perfect power.
+         *
+         * @note Only prime exponents up to log2(`x`) are tested, and each is screened with residues modulo small primes
+         * before a root is computed.
+         */
+        static bool is_perfect_power(const AlgInt& x, AlgInt& base, uint32_t& k);
+
+        /**
+         * @brief Perform `n`! = `ret`, with Luschny's prime swing.
+         *
+         * @note Every product is computed with a balanced product tree, which benefits from Karatsuba multiplication.
+         */
+        static void factorial(uint32_t n, AlgInt& ret);
+
+        /**
+         * @brief Perform the binomial coefficient C(`n`, `k`) = `n`! / (`k`! * (`n`-`k`)!) = `ret`, which is 0 if `k` > `n`.
+         *
+         * @note Computed from its prime factorization (Legendre's formula) with a balanced product tree, without any division.
+         */
+        static void binomial(uint32_t n, uint32_t k, AlgInt& ret);
+
+        /**
+         * @brief Perform the primorial `n`# (the product of every prime up to `n`) = `ret`.
+         *
+         * @note Computed with a balanced product tree.
+         */
+        static void primorial(uint32_t n, AlgInt& ret);
+
+        /**
+         * @brief Computes the gcd of every modulus with the product of all the other moduli (Bernstein's batch GCD).
+         * A result other than 1 means the modulus shares a factor with another modulus of the set.
+         *
+         * @param moduli The moduli to audit, all must be positive.
+         * @param ret The vector to store the results in, where `ret[i]` = `gcd(moduli[i], P / moduli[i])`. May overlap with `moduli`.
+         * @param thread_count The number of threads that share each level of the product and remainder trees.
+         *
+         * @note Runs in about O(M(P) log n) instead of the O(n^2) calls of a pairwise gcd, where M(P) is the cost of
+         * multiplying numbers as large as the product P of all moduli.
+         *
+         * @exception std::domain_error Will throw if any modulus is zero or negative.
+         */
+        static void batch_gcd(const std::vector<AlgInt>& moduli, std::vector<AlgInt>& ret, size_t thread_count = 1);
+
         /**
          * @brief Find the numbers `x` and `y` that fulfills the equation `a` * `x` + `b` * `y` = `gcd(a,b)`.
          * 
@@ -450,6 +673,9 @@ class AlgInt
          * 
          * @return An AlgInt containing gcd(a,b) May overlap with `x` or `y`.
          *
+         * @note Non-negative operands of more than two digits are reduced with the half-gcd, which tracks its steps in a
+         * matrix instead of performing a division per step. `mod_inv()` uses the same path.
+         *
          * @warning If the AlgInts for `x`, `y`, or the return AlgInt overlap, the behavior is undefined.
          */
         static AlgInt ext_gcd(const AlgInt& a, const AlgInt& b, AlgInt& x, AlgInt& y);
@@ -461,10 +687,80 @@ class AlgInt
          * @param m The modulus.
          * @param ret The AlgInt to store the result in. May overlap with `x` or `m`.
          * 
+         * @note Only the cofactor of `x` is tracked, with Lehmer steps that update it in a single pass over the digits.
+         * Operands of more than 8192 digits are first reduced with the half-gcd.
+         *
          * @exception std::domain_error Will be thrown if `x` has no inverse mod `m`. This happens only if `gcd(x, m) != 1`.
+         * @exception std::domain_error Will be thrown if `m` is zero or negative.
          */
         static void mod_inv(const AlgInt& x, const AlgInt& m, AlgInt& inv);
 
+        /**
+         * @brief Returns `m`^-1 (mod 2^64) for an odd native `m`, in five Newton steps.
+         *
+         * @note The low 32 bits are `m`^-1 (mod 2^32). Used for every Montgomery setup, and as the seed of
+         * `inv_mod_pow2()`.
+         *
+         * @warning The result is meaningless if `m` is even.
+         */
+        static uint64_t inv_u64(uint64_t m);
+
+        /**
+         * @brief Perform `m`^-1 (mod 2^`k`) = `ret` by Newton (Hensel) lifting, without Euclid's algorithm.
+         *
+         * @param m The odd number to invert (negative values are supported).
+         * @param k The power of two of the modulus.
+         * @param ret The AlgInt to store the result in, within [0, 2^`k`). May overlap with `m`.
+         *
+         * @note Costs O(1) for `k` <= 64, and a small constant number of multiplications otherwise.
+         *
+         * @exception std::domain_error Will be thrown if `m` is even or zero.
+         */
+        static void inv_mod_pow2(const AlgInt& m, size_t k, AlgInt& ret);
+
+        /**
+         * @brief Perform `x` / `y` = `q`, where `y` is known to divide `x` evenly.
+         *
+         * @param q The AlgInt to store the quotient in. May overlap with `x` or `y`.
+         *
+         * @note Large divisions multiply by `y`^-1 (mod 2^k) (see `inv_mod_pow2()`) instead of performing long division.
+         *
+         * @warning The result is meaningless if `y` does not divide `x`.
+         *
+         * @exception std::domain_error Will be thrown if `y` is zero.
+         */
+        static void div_exact(const AlgInt& x, const AlgInt& y, AlgInt& q);
+
+        /**
+         * @brief Perform `a`^(1/2) (mod `p`) = `ret` for a prime `p`. The other square root is `p` - `ret`.
+         *
+         * @param a Any AlgInt, which is reduced modulo `p` first.
+         * @param p The prime modulus.
+         * @param ret The AlgInt to store the result in, within [0, `p`). May overlap with `a` or `p`.
+         *
+         * @note A single exponentiation for `p` == 3 (mod 4) and `p` == 5 (mod 8) (Atkin), and Tonelli-Shanks or
+         * Cipolla's method (for a large power of two in `p` - 1) otherwise. All in Montgomery form.
+         *
+         * @exception std::domain_error Will be thrown if `a` is not a quadratic residue (mod `p`), if `p` is even
+         * (other than 2), zero or negative, or if `p` is detected to not be prime.
+         */
+        static void mod_sqrt(const AlgInt& a, const AlgInt& p, AlgInt& ret);
+
+        /**
+         * @brief Inverts every element of `in` modulo `m` with Montgomery's trick (a single `mod_inv()` and 3(n-1) modular multiplications).
+         *
+         * @param in The elements to invert.
+         * @param m The modulus.
+         * @param out The vector to store the inverses in, each within [0, m). May overlap with `in`.
+         *
+         * @note Elements without an inverse (`gcd(in[i], m) != 1`) do not abort the batch, and receive `out[i]` = 0.
+         * Elements that are zero (mod `m`) are skipped up front. Any others (only possible for a composite `m`) are
+         * isolated by repeatedly halving the batch.
+         *
+         * @exception std::domain_error Will be thrown if `m` is zero or negative.
+         */
+        static void batch_mod_inv(const std::vector<AlgInt>& in, const AlgInt& m, std::vector<AlgInt>& out);
+
         /**
          * @brief Performs one round of the probabilistic Miller-Rabin primality test. Each successive run of `miller_rabin()` decreases the chances of a false positive.
          * 
@@ -477,9 +773,131 @@ class AlgInt
          * @warning `miller_rabin()` might return true even if `candidate` is not prime. However, `miller_rabin()` will never return false for a real prime. In order to prevent false positives, `miller_rabin()` should be ran repeatedly with randomly chosen `witness` values until a desired probability is reached. Each trial of `miller_rabin()` has a worst-case probability of `25%` to return a false positive. 
          *
          * @exception std::domain_error Will be thrown if `witness` is not within the range [2, candidate-1).
+         *
+         * @note Testing several witnesses against one candidate is cheaper with a `MillerRabinContext`.
          */
         static bool miller_rabin(const AlgInt& candidate, const AlgInt& witness);
 
+        /**
+         * @brief Performs the Baillie-PSW primality test (a base 2 Miller-Rabin test and a strong Lucas probable prime test).
+         *
+         * @param candidate The number to check for primality.
+         *
+         * @return true `candidate` is almost certainly prime. No composite that passes the test is known.
+         * @return false `candidate` is certainly not prime.
+         *
+         * @note Costs about three exponentiations, compared to one per `miller_rabin()` round.
+         */
+        static bool is_probable_prime_bpsw(const AlgInt& candidate);
+
+        /**
+         * @brief Determines whether `n` is prime, with a deterministic Miller-Rabin test using native integers.
+         *
+         * @return true `n` is prime.
+         * @return false `n` is not prime.
+         *
+         * @note Exact for every `n` (no false positives), and performs no allocation. `is_probable_prime_bpsw()` and
+         * `next_prime()` use this for candidates of at most 64 bits.
+         */
+        static bool is_prime_u64(uint64_t n);
+
+        /**
+         * @brief Finds the smallest (probable) prime above `x`.
+         *
+         * @param x The starting point of the search, which is excluded.
+         * @param randfunc The random function for Miller-Rabin witnesses. If nullptr, fixed witnesses are used instead.
+         *
+         * @return The smallest prime above `x`, or 2 if `x` < 2.
+         *
+         * @note Candidates are sieved by the first 1000 odd primes over an interval, so only about 1 in 8 candidates
+         * is tested with Miller-Rabin (25 rounds).
+         */
+        static AlgInt next_prime(const AlgInt& x, uint32_t(*randfunc)() = nullptr);
+
+        /**
+         * @brief Generates a random (probable) prime of exactly `bitsize` bits.
+         *
+         * @param bitsize The bitsize of the prime.
+         * @param randfunc The random function for the starting point and the Miller-Rabin witnesses.
+         *
+         * @exception std::domain_error Will throw if `bitsize` < 2.
+         */
+        static AlgInt random_prime(size_t bitsize, uint32_t(*randfunc)());
+
+        /**
+         * @brief Generates a random (probable) prime of exactly `bitsize` bits, searching on one thread per random function.
+         *
+         * @param bitsize The bitsize of the prime.
+         * @param randfuncs One random function per worker thread (the calling thread uses the first). Each function is
+         * only ever called from its own thread.
+         *
+         * @note The first worker to find a prime cancels the others, which stop before their next candidate or Miller-Rabin round.
+         *
+         * @exception std::domain_error Will throw if `bitsize` < 2, or if `randfuncs` is empty or contains nullptr.
+         */
+        static AlgInt random_prime(size_t bitsize, const std::vector<uint32_t(*)()>& randfuncs);
+
+        /**
+         * @brief Generates a random (probable) safe prime `p` = 2`q` + 1 of exactly `bitsize` bits, where `q` is also prime.
+         *
+         * @param bitsize The bitsize of the safe prime.
+         * @param randfunc The random function for the starting point and the Miller-Rabin witnesses.
+         *
+         * @note `q` and `p` are sieved together, and both must pass a base 2 Miller-Rabin round before `q` is tested
+         * further. `p` is then proven prime by Pocklington's criterion, so it needs no further rounds of its own.
+         *
+         * @exception std::domain_error Will throw if `bitsize` < 3.
+         */
+        static AlgInt random_safe_prime(size_t bitsize, uint32_t(*randfunc)());
+
+
+    //? RSA
+
+        /**
+         * @brief Perform the RSA private operation `x` ** `d` % (`p` * `q`) = `ret` with the Chinese Remainder Theorem.
+         *
+         * @param x The input (ciphertext or message), must be below `p` * `q`.
+         * @param p The first prime factor of the modulus.
+         * @param q The second prime factor of the modulus.
+         * @param dp The exponent `d` % (`p` - 1).
+         * @param dq The exponent `d` % (`q` - 1).
+         * @param q_inv The inverse of `q` `(mod p)`.
+         * @param ret The AlgInt to store the result in. May overlap with any input.
+         * @param threaded If true, the `q` half is exponentiated on a second thread.
+         *
+         * @note About 4 times cheaper than `mod_exp(x, d, p*q, ret)`. Threading roughly halves the latency again.
+         *
+         * @exception std::domain_error Will throw if any input is negative, or if `p` or `q` == 0.
+         */
+        static void rsa_crt(const AlgInt& x, const AlgInt& p, const AlgInt& q, const AlgInt& dp, const AlgInt& dq, const AlgInt& q_inv, AlgInt& ret, bool threaded = false);
+
+        /**
+         * @brief Generates a (multi-prime) RSA key with public exponent `e` = 65537 and a modulus of exactly `bitsize` bits.
+         *
+         * @param bitsize The bitsize of the modulus `n`.
+         * @param prime_count The number of distinct primes in `n` (2 for standard RSA, 3 or 4 for multi-prime RSA).
+         * @param randfunc The random function used for primes and Miller-Rabin witnesses.
+         * @param key The RSAKey to store the key in.
+         *
+         * @exception std::domain_error Will throw if `prime_count` < 2, or if any prime would be shorter than 64 bits.
+         */
+        static void rsa_keygen(size_t bitsize, size_t prime_count, uint32_t(*randfunc)(), RSAKey& key);
+
+        /**
+         * @brief Perform the RSA private operation `x` ** `key.d` % `key.n` = `ret` with the Chinese Remainder Theorem over every prime of `key`.
+         *
+         * @param x The input (ciphertext or message), must be below `key.n`.
+         * @param key The private key, as generated by `rsa_keygen()`.
+         * @param ret The AlgInt to store the result in. May overlap with `x`.
+         * @param threaded If true, every prime except the first is exponentiated on its own thread.
+         *
+         * @note With u primes, each exponentiation is 1/u of the modulus length, which makes 3 and 4 prime keys
+         * about 2.25 and 4 times cheaper than two prime CRT (`rsa_crt()`).
+         *
+         * @exception std::domain_error Will throw if `x` is negative, or if `key` is incomplete.
+         */
+        static void rsa_private(const AlgInt& x, const RSAKey& key, AlgInt& ret, bool threaded = false);
+
 
     //? Comparison
         
@@ -644,6 +1062,11 @@ class AlgInt
          */
         size_t output_arr_base2pow32(uint32_t*& arr);
 
+        /**
+         * @brief Returns the lowest 64 bits of the AlgInt's magnitude.
+         */
+        uint64_t output_uint64() const;
+
         //* This overload allows AlgInt to be printed directly with `std::cout << AlgInt`.
         friend std::ostream& operator<<(std::ostream& out, const AlgInt& obj);
 
@@ -715,4 +1138,208 @@ class AlgInt
         bool operator>=(const AlgInt& other) const;
 };
 
+struct AlgInt::SpecialMod
+{
+    ModForm form = ModForm::General;
+
+    // m = 2^k - c
+    AlgInt m;
+    AlgInt c;
+    size_t k = 0;
+
+    // Solinas only: c = sum of (negative ? -1 : 1) << exponent.
+    std::vector<std::pair<size_t, bool>> terms;
+};
+
+struct AlgInt::CofactorMatrix
+{
+    // big' = a*big + b*sml, sml' = c*big + d*sml
+    int64_t a = 1;
+    int64_t b = 0;
+    int64_t c = 0;
+    int64_t d = 1;
+};
+
+struct AlgInt::HalfGcdMatrix
+{
+    // (a, b) = M * (a', b'), where every entry is non-negative and det(M) = det.
+    AlgInt m00 = 1;
+    AlgInt m01 = 0;
+    AlgInt m10 = 0;
+    AlgInt m11 = 1;
+    int det = 1;
+
+    // M = M * [[q, 1], [1, 0]] (a single Euclid step with the quotient q).
+    void mul_step(const AlgInt& q);
+
+    // M = M * L^-1, where L holds the (forward) steps of lehmer_matrix().
+    void mul_lehmer(const CofactorMatrix& step);
+
+    // M = M * other
+    void mul(const HalfGcdMatrix& other);
+
+    // (a, b) = M^-1 * (a, b). Returns false (a and b are unchanged) unless the result is a valid Euclid pair a > b >= 0.
+    bool apply_inverse(AlgInt& a, AlgInt& b) const;
+};
+
+/**
+ * @brief Precomputed Montgomery space for a single odd modulus `m`. Values in Montgomery space are
+ * kept lazily reduced within [0, 2m), which allows long chains of multiplications (such as an
+ * exponentiation) to skip the final conditional subtraction of every Montgomery reduction.
+ *
+ * @note All methods are const, so a single context may be shared between threads.
+ */
+class MontgomeryContext
+{
+    private:
+
+        AlgInt m;
+        AlgInt m2;          // 2m, the bound of the lazy range.
+        AlgInt m_prime;     // -m^-1 (mod R)
+        AlgInt r_sub;       // R - 1
+        AlgInt r2;          // R^2 (mod m)
+        AlgInt r1;          // R (mod m), Montgomery form of 1.
+        size_t r_shift;     // R = 2^r_shift
+
+        /**
+         * @brief Performs `x` * R^-1 (mod m) = `x` in place. The result is within [0, 2m) if `x` < 4m^2.
+         */
+        void redc(AlgInt& x, AlgInt& temp) const;
+
+    public:
+
+        /**
+         * @brief Constructs the Montgomery space for `m`.
+         *
+         * @exception std::domain_error Will throw if `m` is negative, zero, or even.
+         */
+        MontgomeryContext(const AlgInt& m);
+
+        /**
+         * @brief Converts `x` into Montgomery space (`x` * R (mod m)) = `ret`. The result is within [0, m).
+         *
+         * @param x Any AlgInt, which is reduced modulo `m` first if required.
+         * @param ret The AlgInt to store the result in. May overlap with `x`.
+         */
+        void to_mont(const AlgInt& x, AlgInt& ret) const;
+
+        /**
+         * @brief Converts `x` out of Montgomery space (`x` * R^-1 (mod m)) = `ret`. The result is within [0, m).
+         *
+         * @param x A lazily reduced AlgInt in Montgomery space.
+         * @param ret The AlgInt to store the result in. May overlap with `x`.
+         */
+        void from_mont(const AlgInt& x, AlgInt& ret) const;
+
+        /**
+         * @brief Fully reduces a lazily reduced `x` from [0, 2m) into [0, m), in place. The result remains in Montgomery space.
+         */
+        void reduce(AlgInt& x) const;
+
+        /**
+         * @brief Perform `x` * `y` = `ret` in Montgomery space.
+         *
+         * @param ret The AlgInt to store the result in. May overlap with `x` or `y`.
+         *
+         * @note `x` and `y` must be within [0, 2m), and so is the result.
+         */
+        void mul(const AlgInt& x, const AlgInt& y, AlgInt& ret) const;
+
+        /**
+         * @brief Perform `x` + `y` = `ret` in Montgomery space. The result is within [0, 2m).
+         *
+         * @param ret The AlgInt to store the result in. May overlap with `x` or `y`.
+         */
+        void add(const AlgInt& x, const AlgInt& y, AlgInt& ret) const;
+
+        /**
+         * @brief Perform `x` - `y` = `ret` in Montgomery space. The result is within [0, 2m).
+         *
+         * @param ret The AlgInt to store the result in. May overlap with `x` or `y`.
+         */
+        void sub(const AlgInt& x, const AlgInt& y, AlgInt& ret) const;
+
+        /**
+         * @brief Perform `x` ** `y` = `ret` in Montgomery space.
+         *
+         * @param x The base, within [0, 2m).
+         * @param y The exponent, must be positive.
+         * @param ret The AlgInt to store the result in. May overlap with `x` or `y`.
+         */
+        void exp(const AlgInt& x, const AlgInt& y, AlgInt& ret) const;
+
+        /**
+         * @brief Returns 1 in Montgomery space (R mod m).
+         */
+        const AlgInt& one() const;
+
+        /**
+         * @brief Returns the modulus `m`.
+         */
+        const AlgInt& get_mod() const;
+};
+
+class MillerRabinContext
+{
+    private:
+
+        MontgomeryContext ctx;
+        AlgInt cand_sub1;   // candidate - 1
+        AlgInt d;           // candidate - 1 = d << s, d is odd.
+        size_t s;
+        AlgInt minus_one;   // -1 in Montgomery space.
+
+    public:
+
+        /**
+         * @brief Precomputes everything that Miller-Rabin needs for `candidate`, so that any number of witnesses can be tested against it.
+         *
+         * @exception std::domain_error Will throw if `candidate` is even or below 3.
+         */
+        MillerRabinContext(const AlgInt& candidate);
+
+        /**
+         * @brief Performs one round of the Miller-Rabin primality test with `witness`. See `AlgInt::miller_rabin()`.
+         *
+         * @return true The candidate is probably prime. `witness` might be a strong liar.
+         * @return false The candidate is certainly not prime.
+         *
+         * @exception std::domain_error Will be thrown if `witness` is not within the range [2, candidate-1).
+         */
+        bool test(const AlgInt& witness) const;
+
+        /**
+         * @brief Performs one round of the Miller-Rabin primality test per witness, spread across `thread_count` threads.
+         *
+         * @param witnesses The witnesses to test, each within the range [2, candidate-1).
+         * @param thread_count The number of worker threads, including the calling thread.
+         *
+         * @return true The candidate passed every witness, and is probably prime.
+         * @return false Some witness proved the candidate is not prime. The remaining witnesses are skipped.
+         *
+         * @note Workers stop taking witnesses once any witness fails, but finish the round they are performing.
+         *
+         * @exception std::domain_error Will be thrown if any witness is not within the range [2, candidate-1).
+         */
+        bool test_parallel(const std::vector<AlgInt>& witnesses, size_t thread_count) const;
+
+        /**
+         * @brief Returns the candidate.
+         */
+        const AlgInt& get_candidate() const;
+};
+
+/**
+ * @brief An RSA private key with any number of primes (RFC 8017 multi-prime RSA). Generated by `AlgInt::rsa_keygen()`.
+ */
+struct RSAKey
+{
+    AlgInt n;                   // Public modulus, the product of all primes.
+    AlgInt e;                   // Public exponent.
+    AlgInt d;                   // Private exponent.
+    std::vector<AlgInt> primes; // r_i (primes[0] and primes[1] are p and q)
+    std::vector<AlgInt> exps;   // d (mod r_i - 1)
+    std::vector<AlgInt> coeffs; // (r_0 * ... * r_(i-1))^-1 (mod r_i), coeffs[1] is q^-1 (mod p). coeffs[0] is unused.
+};
+
 #endif // __ALGINATE_HPP__
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <chrono>
 #include <stdexcept>
+#include <thread>
 
 #define STOPWATCH_NOW std::chrono::high_resolution_clock::now()
 
@@ -14,13 +15,29 @@
 
 typedef uint32_t(*u32rand)();
 typedef uint8_t(*u8rand)();
-AlgInt gen_prime(size_t bitsize);
 
 void basic_arithmetic();
 void input_output_test();
 void exponentiation_timing();
 void mont_exp_timing();
+void special_mod_timing();
+void mont_exp_batch_timing();
+void rsa_verify_timing();
+void prime_search_timing(size_t bitsize);
+void safe_prime_timing(size_t bitsize);
+void primality_timing(size_t bitsize);
+void small_primality_timing();
+void batch_gcd_timing(size_t count);
+void gcd_timing();
+void mod_inv_timing();
+void batch_mod_inv_timing(size_t count);
+void jacobi_timing();
+void root_timing();
+void perfect_power_timing(size_t bitsize);
+void mod_sqrt_timing(size_t bitsize);
+void factorial_timing();
 void rsa_example(size_t bitsize);
+void multi_prime_rsa_timing(size_t bitsize);
 
 int main()
 {
@@ -33,9 +50,27 @@ int main()
     basic_arithmetic();
     exponentiation_timing();
     mont_exp_timing();
+    special_mod_timing();
+    mont_exp_batch_timing();
+    rsa_verify_timing();
+    prime_search_timing(1024);
+    safe_prime_timing(256);
+    primality_timing(1024);
+    primality_timing(2048);
+    small_primality_timing();
+    batch_gcd_timing(128);
+    gcd_timing();
+    mod_inv_timing();
+    batch_mod_inv_timing(1000);
+    jacobi_timing();
+    root_timing();
+    perfect_power_timing(1024);
+    mod_sqrt_timing(256);
+    factorial_timing();
     rsa_example(512);
     rsa_example(1024);
     rsa_example(2048);
+    multi_prime_rsa_timing(4096);
 
     return 0;
 }
@@ -581,6 +616,765 @@ void mont_exp_timing()
 
         std::cout << "Time took: " << std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count() << " ms\n\n";
     }
+
+    {
+        //* Zero and one operands leave redc() with values far below R.
+        AlgInt m = AlgInt(2048/32, (u32rand) rand);
+        m.set_bit(0);   // Forces m to be odd.
+        AlgInt x = AlgInt(2048/32, (u32rand) rand) % m;
+        MontgomeryContext ctx(m);
+
+        AlgInt zero, x_mont, prod, back;
+        ctx.to_mont(0, zero);
+        ctx.to_mont(x, x_mont);
+        bool match = (zero == 0);
+
+        ctx.mul(x_mont, zero, prod);
+        ctx.reduce(prod);
+        match &= (prod == 0);
+
+        ctx.mul(x_mont, ctx.one(), prod);
+        ctx.from_mont(prod, back);
+        match &= (back == x);
+
+        ctx.mul(ctx.one(), ctx.one(), prod);
+        ctx.from_mont(prod, back);
+        match &= (back == 1);
+
+        ctx.exp(x_mont, 0, prod);
+        ctx.from_mont(prod, back);
+        match &= (back == 1);
+
+        std::cout << "Zero and one operands: " << ((match) ? "yes" : "NO") << "\n\n";
+    }
+}
+
+void special_mod_timing()
+{
+    std::cout << "\n---Special-Form Modulus Exponentiation (vs Montgomery)---\n";
+
+    const char* names[] = {"2^521 - 1", "2^255 - 19", "P-384"};
+    AlgInt mods[3];
+    mods[0] = (AlgInt(1) << 521) - 1;
+    mods[1] = (AlgInt(1) << 255) - 19;
+    mods[2] = (AlgInt(1) << 384) - (AlgInt(1) << 128) - (AlgInt(1) << 96) + (AlgInt(1) << 32) - 1;
+
+    for (size_t i = 0; i < 3; i++)
+    {
+        const AlgInt& m = mods[i];
+        const size_t rounds = 20;
+
+        AlgInt x = AlgInt(m.get_size(), (u32rand) rand) % m;
+        AlgInt y = AlgInt(m.get_size(), (u32rand) rand);
+        AlgInt q_mont, q_special;
+
+        std::cout << "m: " << names[i] << " (form " << (int) AlgInt::classify_mod(m) << ")\n";
+
+        auto t1 = STOPWATCH_NOW;
+        for (size_t j = 0; j < rounds; j++)
+            AlgInt::mont_exp(x, y, m, q_mont);
+        auto t2 = STOPWATCH_NOW;
+        for (size_t j = 0; j < rounds; j++)
+            AlgInt::mod_exp(x, y, m, q_special);
+        auto t3 = STOPWATCH_NOW;
+
+        std::cout << "mont_exp: " << std::chrono::duration_cast<std::chrono::microseconds>(t2-t1).count()/rounds << " μs\n";
+        std::cout << "mod_exp:  " << std::chrono::duration_cast<std::chrono::microseconds>(t3-t2).count()/rounds << " μs\n";
+        std::cout << "Results match: " << ((q_mont == q_special) ? "yes" : "NO") << '\n';
+
+        //* mod_mul() with the modulus classified once, against a plain division.
+        AlgInt::SpecialMod sm;
+        AlgInt::special_mod(m, sm);
+        AlgInt prod, q_div;
+        AlgInt::mod_mul(x, q_special, sm, prod);
+        AlgInt::mod(x * q_special, m, q_div);
+        std::cout << "mod_mul match: " << ((prod == q_div) ? "yes" : "NO") << "\n\n";
+    }
+}
+
+void mont_exp_batch_timing()
+{
+    std::cout << "\n---Batched Montgomery Exponentiation (2048-bit, independent moduli)---\n";
+
+    const size_t bitsize = 2048;
+    const size_t count = 16;
+    std::vector<AlgInt> x, y, m, q_batch;
+    for (size_t i = 0; i < count; i++)
+    {
+        m.push_back(AlgInt(bitsize/32, (u32rand) rand));
+        m.back().set_bit(0);   // Forces m to be odd.
+        x.push_back(AlgInt(bitsize/32, (u32rand) rand) % m.back());
+        y.push_back(AlgInt(bitsize/32, (u32rand) rand));
+    }
+
+    std::vector<AlgInt> q_single(count);
+    auto t1 = STOPWATCH_NOW;
+    for (size_t i = 0; i < count; i++)
+        AlgInt::mont_exp(x[i], y[i], m[i], q_single[i]);
+    auto t2 = STOPWATCH_NOW;
+    AlgInt::mont_exp_batch(x, y, m, q_batch);
+    auto t3 = STOPWATCH_NOW;
+
+    bool match = true;
+    for (size_t i = 0; i < count; i++)
+        match &= (q_single[i] == q_batch[i]);
+
+    std::cout << "Exponentiations: " << count << '\n';
+    std::cout << "mont_exp (sequential): " << std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count() << " ms\n";
+    std::cout << "mont_exp_batch:        " << std::chrono::duration_cast<std::chrono::milliseconds>(t3-t2).count() << " ms\n";
+    std::cout << "Results match: " << ((match) ? "yes" : "NO") << "\n\n";
+}
+
+void rsa_verify_timing()
+{
+    std::cout << "\n---Public Exponent Throughput (e = 65537, vs Montgomery)---\n";
+
+    const size_t sizes[] = {1024, 2048, 4096};
+    for (size_t bitsize : sizes)
+    {
+        const size_t rounds = 200;
+        AlgInt e = 65537;
+        AlgInt m = AlgInt(bitsize/32, (u32rand) rand);
+        m.set_bit(bitsize-1);   // Forces m to be exactly bitsize bits.
+        m.set_bit(0);           // Forces m to be odd.
+        AlgInt s = AlgInt(bitsize/32, (u32rand) rand) % m;
+        AlgInt q_mont, q_short;
+
+        auto t1 = STOPWATCH_NOW;
+        for (size_t i = 0; i < rounds; i++)
+            AlgInt::mont_exp(s, e, m, q_mont);
+        auto t2 = STOPWATCH_NOW;
+        for (size_t i = 0; i < rounds; i++)
+            AlgInt::mod_exp(s, e, m, q_short);
+        auto t3 = STOPWATCH_NOW;
+
+        auto mont_us = std::chrono::duration_cast<std::chrono::microseconds>(t2-t1).count();
+        auto short_us = std::chrono::duration_cast<std::chrono::microseconds>(t3-t2).count();
+        std::cout << "m bitsize: " << bitsize << '\n';
+        std::cout << "mont_exp: " << rounds * 1000000 / (mont_us + 1) << " verifications/s\n";
+        std::cout << "mod_exp:  " << rounds * 1000000 / (short_us + 1) << " verifications/s\n";
+        std::cout << "Results match: " << ((q_mont == q_short) ? "yes" : "NO") << "\n\n";
+    }
+
+    {
+        //* A small base stays below 2^(k-1) for the first squarings, which Barrett reduction must pass through.
+        AlgInt e = 65537;
+        AlgInt m = AlgInt(2048/32, (u32rand) rand);
+        m.set_bit(2047);
+        m.set_bit(0);
+        AlgInt q_mont, q_short;
+        AlgInt::mont_exp(AlgInt(2), e, m, q_mont);
+        AlgInt::mod_exp(AlgInt(2), e, m, q_short);
+
+        std::cout << "Small base (2^65537, 2048-bit m): " << ((q_mont == q_short) ? "yes" : "NO") << "\n\n";
+    }
+}
+
+// Independent xorshift generators, one per prime search thread.
+template <uint32_t SEED>
+uint32_t xorshift_rand()
+{
+    static uint32_t state = SEED ^ (uint32_t) time(NULL);
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void prime_search_timing(size_t bitsize)
+{
+    std::cout << "\n---Parallel Prime Search (" << bitsize << ")---\n";
+
+    const size_t rounds = 8;
+    std::vector<u32rand> randfuncs = {xorshift_rand<0x9E3779B9>, xorshift_rand<0x85EBCA6B>, xorshift_rand<0xC2B2AE35>, xorshift_rand<0x27D4EB2F>};
+
+    auto t1 = STOPWATCH_NOW;
+    for (size_t i = 0; i < rounds; i++)
+        AlgInt::random_prime(bitsize, (u32rand) rand);
+    auto t2 = STOPWATCH_NOW;
+    for (size_t i = 0; i < rounds; i++)
+        AlgInt::random_prime(bitsize, randfuncs);
+    auto t3 = STOPWATCH_NOW;
+
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << '\n';
+    std::cout << "1 thread:  " << std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count()/rounds << " ms per prime\n";
+    std::cout << randfuncs.size() << " threads: " << std::chrono::duration_cast<std::chrono::milliseconds>(t3-t2).count()/rounds << " ms per prime\n\n";
+}
+
+void safe_prime_timing(size_t bitsize)
+{
+    std::cout << "\n---Safe Prime Generation (" << bitsize << ")---\n";
+
+    const size_t rounds = 4;
+    AlgInt q, p;
+
+    //* Naive: random primes q until 2q+1 passes as well.
+    auto t1 = STOPWATCH_NOW;
+    for (size_t i = 0; i < rounds; i++)
+    {
+        do
+        {
+            q = AlgInt::random_prime(bitsize - 1, (u32rand) rand);
+            p = q * 2 + 1;
+        } while (!AlgInt::is_probable_prime_bpsw(p));
+    }
+    auto t2 = STOPWATCH_NOW;
+    for (size_t i = 0; i < rounds; i++)
+        p = AlgInt::random_safe_prime(bitsize, (u32rand) rand);
+    auto t3 = STOPWATCH_NOW;
+
+    q = (p - 1) >> 1;
+    std::cout << "Safe prime: " << p << '\n';
+    std::cout << "Bitsize: " << p.get_bitsize() << ", p and (p-1)/2 pass BPSW: " << ((AlgInt::is_probable_prime_bpsw(p) && AlgInt::is_probable_prime_bpsw(q)) ? "yes" : "no") << '\n';
+    std::cout << "random_prime then check 2q+1: " << std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count()/rounds << " ms per safe prime\n";
+    std::cout << "random_safe_prime:            " << std::chrono::duration_cast<std::chrono::milliseconds>(t3-t2).count()/rounds << " ms per safe prime\n\n";
+}
+
+void primality_timing(size_t bitsize)
+{
+    std::cout << "\n---Primality Certification (" << bitsize << ")---\n";
+
+    AlgInt prime = AlgInt::random_prime(bitsize, (u32rand) rand);
+    const size_t rounds = 25;
+
+    // 25 Miller-Rabin rounds (as in random_prime) against a single Baillie-PSW test.
+    bool mr_result = true;
+    auto t1 = STOPWATCH_NOW;
+    for (size_t i = 0; i < rounds; i++)
+    {
+        AlgInt wit = AlgInt(bitsize/32 - 1, (u32rand) rand);
+        mr_result &= AlgInt::miller_rabin(prime, wit);
+    }
+    auto t2 = STOPWATCH_NOW;
+    bool bpsw_result = AlgInt::is_probable_prime_bpsw(prime);
+    auto t3 = STOPWATCH_NOW;
+
+    // The same rounds against a shared MillerRabinContext.
+    MillerRabinContext mr(prime);
+    bool ctx_result = true;
+    for (size_t i = 0; i < rounds; i++)
+    {
+        AlgInt wit = AlgInt(bitsize/32 - 1, (u32rand) rand);
+        ctx_result &= mr.test(wit);
+    }
+    auto t4 = STOPWATCH_NOW;
+
+    // The same rounds evaluated on 4 threads.
+    std::vector<AlgInt> witnesses;
+    for (size_t i = 0; i < rounds; i++)
+        witnesses.push_back(AlgInt(bitsize/32 - 1, (u32rand) rand));
+    auto t5 = STOPWATCH_NOW;
+    bool parallel_result = mr.test_parallel(witnesses, 4);
+    auto t6 = STOPWATCH_NOW;
+
+    std::cout << "Miller-Rabin (" << rounds << " rounds): " << std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count() << " ms\n";
+    std::cout << "MillerRabinContext (" << rounds << " rounds): " << std::chrono::duration_cast<std::chrono::milliseconds>(t4-t3).count() << " ms\n";
+    std::cout << "MillerRabinContext (" << rounds << " rounds, 4 threads): " << std::chrono::duration_cast<std::chrono::milliseconds>(t6-t5).count() << " ms\n";
+    std::cout << "Baillie-PSW:             " << std::chrono::duration_cast<std::chrono::milliseconds>(t3-t2).count() << " ms\n";
+    std::cout << "All prime: " << ((mr_result && bpsw_result && ctx_result && parallel_result) ? "yes" : "NO") << "\n\n";
+}
+
+void small_primality_timing()
+{
+    std::cout << "\n---64-bit Primality (20000 odd candidates below 2^64)---\n";
+
+    const uint64_t start = UINT64_MAX - 40000;
+    const uint32_t witnesses[] = {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+    size_t mr_count = 0, native_count = 0;
+
+    // The same 7 deterministic witnesses, through AlgInt and natively.
+    auto t1 = STOPWATCH_NOW;
+    for (uint64_t n = start; n < UINT64_MAX; n += 2)
+    {
+        AlgInt cand = n;
+        bool prime = true;
+        for (size_t i = 0; i < 7 && prime; i++)
+        {
+            AlgInt wit = witnesses[i] % n;
+            if (wit >= 2 && wit < cand - 1)
+                prime = AlgInt::miller_rabin(cand, wit);
+        }
+        mr_count += prime;
+    }
+    auto t2 = STOPWATCH_NOW;
+    for (uint64_t n = start; n < UINT64_MAX; n += 2)
+        native_count += AlgInt::is_prime_u64(n);
+    auto t3 = STOPWATCH_NOW;
+
+    std::cout << "miller_rabin: " << std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count() << " ms\n";
+    std::cout << "is_prime_u64: " << std::chrono::duration_cast<std::chrono::milliseconds>(t3-t2).count() << " ms\n";
+    std::cout << "Primes found: " << native_count << " (match: " << ((mr_count == native_count) ? "yes" : "NO") << ")\n\n";
+}
+
+void batch_gcd_timing(size_t count)
+{
+    std::cout << "\n---Batch GCD (" << count << " x 1024-bit moduli)---\n";
+
+    // Random 1024-bit moduli, where two moduli secretly share a 512-bit factor.
+    std::vector<AlgInt> moduli;
+    for (size_t i = 0; i < count; i++)
+        moduli.push_back(AlgInt(16, (u32rand) rand) * AlgInt(16, (u32rand) rand));
+    AlgInt shared = AlgInt(16, (u32rand) rand);
+    moduli[3] = shared * AlgInt(16, (u32rand) rand);
+    moduli[count-2] = shared * AlgInt(16, (u32rand) rand);
+
+    // Pairwise gcd (count^2 / 2 calls)
+    std::vector<bool> pairwise(count, false);
+    auto t1 = STOPWATCH_NOW;
+    for (size_t i = 0; i < count; i++)
+    {
+        for (size_t j = i+1; j < count; j++)
+        {
+            if (AlgInt::gcd(moduli[i], moduli[j]) != 1)
+                pairwise[i] = pairwise[j] = true;
+        }
+    }
+    auto t2 = STOPWATCH_NOW;
+    std::vector<AlgInt> batch;
+    AlgInt::batch_gcd(moduli, batch);
+    auto t3 = STOPWATCH_NOW;
+    std::vector<AlgInt> batch_threaded;
+    AlgInt::batch_gcd(moduli, batch_threaded, 4);
+    auto t4 = STOPWATCH_NOW;
+
+    bool match = true;
+    for (size_t i = 0; i < count; i++)
+        match &= (pairwise[i] == (batch[i] != 1)) && (batch[i] == batch_threaded[i]);
+
+    std::cout << "Pairwise gcd:          " << std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count() << " ms\n";
+    std::cout << "batch_gcd:             " << std::chrono::duration_cast<std::chrono::milliseconds>(t3-t2).count() << " ms\n";
+    std::cout << "batch_gcd (4 threads): " << std::chrono::duration_cast<std::chrono::milliseconds>(t4-t3).count() << " ms\n";
+    std::cout << "Shared factors found: " << ((batch[3] != 1 && batch[count-2] != 1) ? "yes" : "NO") << ", results match: " << ((match) ? "yes" : "NO") << "\n\n";
+}
+
+void gcd_timing()
+{
+    std::cout << "\n---GCD---\n";
+
+    for (size_t digits : {2, 3, 4, 16, 64, 256, 1024})
+    {
+        const size_t rounds = 4096 / digits;
+        std::vector<AlgInt> a, b;
+        for (size_t i = 0; i < rounds; i++)
+        {
+            a.push_back(AlgInt(digits, (u32rand) rand));
+            b.push_back(AlgInt(digits, (u32rand) rand));
+        }
+
+        //* Euclid's algorithm, one full division per step.
+        AlgInt big, sml, temp;
+        std::vector<AlgInt> euclid(rounds), lehmer(rounds);
+        auto t1 = STOPWATCH_NOW;
+        for (size_t i = 0; i < rounds; i++)
+        {
+            big = a[i];
+            sml = b[i];
+            while (sml != 0)
+            {
+                AlgInt::mod(big, sml, temp);
+                big = sml;
+                sml = temp;
+            }
+            euclid[i] = big;
+        }
+        auto t2 = STOPWATCH_NOW;
+        for (size_t i = 0; i < rounds; i++)
+            AlgInt::gcd(a[i], b[i], lehmer[i]);
+        auto t3 = STOPWATCH_NOW;
+        std::vector<AlgInt> ext(rounds), x(rounds), y(rounds);
+        for (size_t i = 0; i < rounds; i++)
+            ext[i] = AlgInt::ext_gcd(a[i], b[i], x[i], y[i]);
+        auto t4 = STOPWATCH_NOW;
+
+        bool bezout = (ext == lehmer);
+        for (size_t i = 0; i < rounds; i++)
+            bezout &= (a[i]*x[i] + b[i]*y[i] == ext[i]);
+
+        std::cout << digits*32 << " bits, " << rounds << " rounds:\n";
+        std::cout << "\tEuclid:  " << std::chrono::duration_cast<std::chrono::microseconds>(t2-t1).count() << " us\n";
+        std::cout << "\tgcd:     " << std::chrono::duration_cast<std::chrono::microseconds>(t3-t2).count() << " us";
+        std::cout << ((euclid == lehmer) ? "" : " (MISMATCH)") << '\n';
+        std::cout << "\text_gcd: " << std::chrono::duration_cast<std::chrono::microseconds>(t4-t3).count() << " us";
+        std::cout << ((bezout) ? "" : " (WRONG)") << '\n';
+    }
+
+    //* The half-gcd takes over from Lehmer's algorithm at hundreds of thousands of bits.
+    for (size_t digits : {8192, 16384})
+    {
+        AlgInt a(digits, (u32rand) rand), b(digits, (u32rand) rand), g, x, y;
+        auto t1 = STOPWATCH_NOW;
+        AlgInt::gcd(a, b, g);
+        auto t2 = STOPWATCH_NOW;
+        AlgInt::ext_gcd(a, b, x, y);
+        auto t3 = STOPWATCH_NOW;
+
+        std::cout << digits*32 << " bits:\n";
+        std::cout << "\tgcd:     " << std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count() << " ms\n";
+        std::cout << "\text_gcd: " << std::chrono::duration_cast<std::chrono::milliseconds>(t3-t2).count() << " ms\n";
+    }
+    std::cout << '\n';
+}
+
+void mod_inv_timing()
+{
+    std::cout << "\n---Modular Inverse---\n";
+
+    for (size_t digits : {4, 32, 256, 2048})
+    {
+        const size_t rounds = 4096 / digits;
+        AlgInt m(digits, (u32rand) rand);
+        m.set_bit(0);
+
+        // Only invertible values are kept.
+        std::vector<AlgInt> x;
+        while (x.size() < rounds)
+        {
+            x.push_back(AlgInt(digits, (u32rand) rand));
+            if (AlgInt::gcd(x.back(), m) != 1)
+                x.pop_back();
+        }
+
+        //* The inverse from both cofactors of ext_gcd.
+        std::vector<AlgInt> ext(rounds), inv(rounds);
+        AlgInt y;
+        auto t1 = STOPWATCH_NOW;
+        for (size_t i = 0; i < rounds; i++)
+        {
+            AlgInt::ext_gcd(x[i], m, ext[i], y);
+            if (ext[i].get_sign())
+                ext[i] += m;
+        }
+        auto t2 = STOPWATCH_NOW;
+        for (size_t i = 0; i < rounds; i++)
+            AlgInt::mod_inv(x[i], m, inv[i]);
+        auto t3 = STOPWATCH_NOW;
+
+        std::cout << digits*32 << " bits, " << rounds << " rounds:\n";
+        std::cout << "\text_gcd: " << std::chrono::duration_cast<std::chrono::microseconds>(t2-t1).count() << " us\n";
+        std::cout << "\tmod_inv: " << std::chrono::duration_cast<std::chrono::microseconds>(t3-t2).count() << " us";
+        std::cout << ((ext == inv) ? "" : " (MISMATCH)") << '\n';
+    }
+    std::cout << '\n';
+}
+
+void batch_mod_inv_timing(size_t count)
+{
+    std::cout << "\n---Batch Modular Inverse (" << count << " elements)---\n";
+
+    for (size_t digits : {8, 32})
+    {
+        //* A prime modulus, where only the elements == 0 (mod m) are not invertible.
+        AlgInt m = AlgInt::random_prime(digits*32, (u32rand) rand);
+        std::vector<AlgInt> x;
+        for (size_t i = 0; i < count; i++)
+            x.push_back(AlgInt(digits, (u32rand) rand));
+        x[count/3] = m * 3;
+        x[count/2] = 0;
+
+        // A separate mod_inv per element, where failures are caught one by one.
+        std::vector<AlgInt> single(count), batch;
+        auto t1 = STOPWATCH_NOW;
+        for (size_t i = 0; i < count; i++)
+        {
+            try
+            {
+                AlgInt::mod_inv(x[i], m, single[i]);
+            }
+            catch (const std::domain_error&)
+            {
+                single[i] = 0;
+            }
+        }
+        auto t2 = STOPWATCH_NOW;
+        AlgInt::batch_mod_inv(x, m, batch);
+        auto t3 = STOPWATCH_NOW;
+
+        size_t failed = 0;
+        for (size_t i = 0; i < count; i++)
+            failed += (batch[i] == 0);
+
+        std::cout << digits*32 << " bits:\n";
+        std::cout << "\tmod_inv:       " << std::chrono::duration_cast<std::chrono::microseconds>(t2-t1).count() << " us\n";
+        std::cout << "\tbatch_mod_inv: " << std::chrono::duration_cast<std::chrono::microseconds>(t3-t2).count() << " us";
+        std::cout << ((single == batch) ? "" : " (MISMATCH)") << ", " << failed << " not invertible\n";
+    }
+    std::cout << '\n';
+}
+
+void jacobi_timing()
+{
+    std::cout << "\n---Jacobi Symbol---\n";
+
+    for (size_t digits : {2, 4, 16, 64, 256, 1024})
+    {
+        const size_t rounds = 4096 / digits;
+        std::vector<AlgInt> a, n;
+        for (size_t i = 0; i < rounds; i++)
+        {
+            a.push_back(AlgInt(digits, (u32rand) rand));
+            n.push_back(AlgInt(digits, (u32rand) rand));
+            n.back().set_bit(0);
+        }
+
+        //* The textbook algorithm, with a full division per step.
+        std::vector<int> naive(rounds), fast(rounds);
+        AlgInt x, y;
+        auto t1 = STOPWATCH_NOW;
+        for (size_t i = 0; i < rounds; i++)
+        {
+            int result = 1;
+            AlgInt::mod(a[i], n[i], x);
+            y = n[i];
+            while (x != 0)
+            {
+                while (x.get_bit(0) == 0)
+                {
+                    AlgInt::bw_shr(x, 1, x);
+                    if (AlgInt::mod(y, 8) == 3 || AlgInt::mod(y, 8) == 5)
+                        result = -result;
+                }
+
+                std::swap(x, y);
+                if (AlgInt::mod(x, 4) == 3 && AlgInt::mod(y, 4) == 3)
+                    result = -result;
+                AlgInt::mod(x, y, x);
+            }
+            naive[i] = (y == 1) ? result : 0;
+        }
+        auto t2 = STOPWATCH_NOW;
+        for (size_t i = 0; i < rounds; i++)
+            fast[i] = AlgInt::jacobi(a[i], n[i]);
+        auto t3 = STOPWATCH_NOW;
+
+        std::cout << digits*32 << " bits, " << rounds << " rounds:\n";
+        std::cout << "\tmod loop: " << std::chrono::duration_cast<std::chrono::microseconds>(t2-t1).count() << " us\n";
+        std::cout << "\tjacobi:   " << std::chrono::duration_cast<std::chrono::microseconds>(t3-t2).count() << " us";
+        std::cout << ((naive == fast) ? "" : " (MISMATCH)") << '\n';
+    }
+    std::cout << '\n';
+}
+
+void root_timing()
+{
+    std::cout << "\n---Integer Roots---\n";
+
+    for (size_t digits : {4, 32, 256, 2048})
+    {
+        const size_t rounds = 4096 / digits;
+        std::vector<AlgInt> x;
+        for (size_t i = 0; i < rounds; i++)
+            x.push_back(AlgInt(digits, (u32rand) rand));
+
+        //* Newton's iteration at full precision, from a power of two.
+        std::vector<AlgInt> full(rounds), fast(rounds), cube(rounds);
+        AlgInt next, temp;
+        auto t1 = STOPWATCH_NOW;
+        for (size_t i = 0; i < rounds; i++)
+        {
+            full[i] = 0;
+            full[i].set_bit((x[i].get_bitsize() + 1) / 2);
+            while (true)
+            {
+                AlgInt::div(x[i], full[i], temp);
+                AlgInt::add(temp, full[i], next);
+                AlgInt::bw_shr(next, 1, next);
+                if (next >= full[i])
+                    break;
+                std::swap(full[i], next);
+            }
+        }
+        auto t2 = STOPWATCH_NOW;
+        for (size_t i = 0; i < rounds; i++)
+            AlgInt::isqrt(x[i], fast[i]);
+        auto t3 = STOPWATCH_NOW;
+        for (size_t i = 0; i < rounds; i++)
+            AlgInt::iroot(x[i], 3, cube[i]);
+        auto t4 = STOPWATCH_NOW;
+
+        //* floor(cbrt(x))^3 <= x < (floor(cbrt(x)) + 1)^3
+        bool cube_ok = true;
+        for (size_t i = 0; i < rounds; i++)
+        {
+            AlgInt above = cube[i] + 1;
+            cube_ok &= (cube[i] * cube[i] * cube[i] <= x[i]) && (above * above * above > x[i]);
+        }
+
+        std::cout << digits*32 << " bits, " << rounds << " rounds:\n";
+        std::cout << "\tNewton:  " << std::chrono::duration_cast<std::chrono::microseconds>(t2-t1).count() << " us\n";
+        std::cout << "\tisqrt:   " << std::chrono::duration_cast<std::chrono::microseconds>(t3-t2).count() << " us";
+        std::cout << ((full == fast) ? "" : " (MISMATCH)") << '\n';
+        std::cout << "\tiroot 3: " << std::chrono::duration_cast<std::chrono::microseconds>(t4-t3).count() << " us";
+        std::cout << ((cube_ok) ? "" : " (WRONG)") << '\n';
+    }
+    std::cout << '\n';
+}
+
+void perfect_power_timing(size_t bitsize)
+{
+    std::cout << "\n---Perfect Power Detection (" << bitsize << ")---\n";
+
+    // Random numbers, where every eighth one is a power (base^7).
+    const size_t rounds = 64;
+    std::vector<AlgInt> x(rounds);
+    for (size_t i = 0; i < rounds; i++)
+    {
+        if (i % 8 == 0)
+            AlgInt::exp(AlgInt(bitsize / (7*32), (u32rand) rand), AlgInt(7), x[i]);
+        else
+            x[i] = AlgInt(bitsize / 32, (u32rand) rand);
+    }
+
+    //* A root for every prime exponent up to log2(x).
+    std::vector<bool> naive(rounds, false), fast(rounds);
+    AlgInt root, pow, base;
+    uint32_t k;
+    auto t1 = STOPWATCH_NOW;
+    for (size_t i = 0; i < rounds; i++)
+    {
+        for (uint32_t p = 2; p < x[i].get_bitsize() && !naive[i]; p++)
+        {
+            if (!AlgInt::is_prime_u64(p))
+                continue;
+            AlgInt::iroot(x[i], p, root);
+            AlgInt::exp(root, AlgInt(p), pow);
+            naive[i] = (pow == x[i]);
+        }
+    }
+    auto t2 = STOPWATCH_NOW;
+    size_t powers = 0;
+    for (size_t i = 0; i < rounds; i++)
+    {
+        fast[i] = AlgInt::is_perfect_power(x[i], base, k);
+        powers += fast[i];
+    }
+    auto t3 = STOPWATCH_NOW;
+
+    std::cout << "Root per exponent:  " << std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count() << " ms\n";
+    std::cout << "is_perfect_power:   " << std::chrono::duration_cast<std::chrono::milliseconds>(t3-t2).count() << " ms\n";
+    std::cout << "Powers found: " << powers << " (match: " << ((naive == fast) ? "yes" : "NO") << ")\n\n";
+}
+
+void mod_sqrt_timing(size_t bitsize)
+{
+    std::cout << "\n---Modular Square Root (" << bitsize << ")---\n";
+
+    //* Primes p == 3 (mod 4), p == 5 (mod 8), p == 1 (mod 8) and p == 1 (mod 2^(bitsize/4)).
+    std::vector<AlgInt> primes(4);
+    std::vector<const char*> names = {"3 mod 4:      ", "5 mod 8:      ", "1 mod 8:      ", "1 mod 2^k:    "};
+    AlgInt pow2 = 1;
+    AlgInt::bw_shl(pow2, bitsize/4, pow2);
+    size_t found = 0;
+    while (found < 4)
+    {
+        AlgInt cand = AlgInt::random_prime(bitsize, (u32rand) rand);
+        uint32_t cls = (cand.get_bit(1)) ? 0 : (cand.get_bit(2)) ? 1 : 2;
+        if (primes[cls] == 0)
+        {
+            primes[cls] = cand;
+            found++;
+        }
+        if (primes[3] == 0)
+        {
+            AlgInt k(bitsize/32 - bitsize/128, (u32rand) rand);
+            k.set_bit(0);
+            cand = k * pow2 + 1;
+            if (AlgInt::is_probable_prime_bpsw(cand))
+            {
+                primes[3] = cand;
+                found++;
+            }
+        }
+    }
+
+    const size_t rounds = 64;
+    for (size_t i = 0; i < 4; i++)
+    {
+        // Random quadratic residues (squares)
+        std::vector<AlgInt> a(rounds), roots(rounds);
+        for (size_t j = 0; j < rounds; j++)
+            AlgInt::mod_mul(AlgInt(bitsize/32, (u32rand) rand), AlgInt(bitsize/32, (u32rand) rand), primes[i], a[j]);
+        for (size_t j = 0; j < rounds; j++)
+            AlgInt::mod_mul(a[j], a[j], primes[i], a[j]);
+
+        auto t1 = STOPWATCH_NOW;
+        for (size_t j = 0; j < rounds; j++)
+            AlgInt::mod_sqrt(a[j], primes[i], roots[j]);
+        auto t2 = STOPWATCH_NOW;
+
+        bool correct = true;
+        AlgInt sqr;
+        for (size_t j = 0; j < rounds; j++)
+        {
+            AlgInt::mod_mul(roots[j], roots[j], primes[i], sqr);
+            correct &= (sqr == a[j]);
+        }
+
+        std::cout << names[i] << std::chrono::duration_cast<std::chrono::microseconds>(t2-t1).count() / rounds << " us per root";
+        std::cout << ((correct) ? "" : " (WRONG)") << '\n';
+    }
+
+    {
+        //* The least prime k * 2^200 + 1 (k odd), where s = 200 always takes Cipolla's method.
+        AlgInt p, k = 1;
+        do
+        {
+            AlgInt::bw_shl(k, 200, p);
+            AlgInt::add(p, 1, p);
+            AlgInt::add(k, 2, k);
+        } while (!AlgInt::is_probable_prime_bpsw(p));
+
+        bool correct = true;
+        AlgInt root, sqr, minus_one = p - 1;
+        std::vector<AlgInt> a = {1, 4, minus_one, AlgInt(8, (u32rand) rand) * AlgInt(8, (u32rand) rand) % p};
+        AlgInt::mod_mul(a.back(), a.back(), p, a.back());
+        for (const AlgInt& x : a)
+        {
+            AlgInt::mod_sqrt(x, p, root);
+            AlgInt::mod_mul(root, root, p, sqr);
+            correct &= (sqr == x);
+        }
+
+        std::cout << "Cipolla (p - 1 = k * 2^200): " << ((correct) ? "yes" : "NO") << '\n';
+    }
+    std::cout << '\n';
+}
+
+void factorial_timing()
+{
+    std::cout << "\n---Factorial, Binomial and Primorial---\n";
+
+    for (uint32_t n : {10000, 100000, 1000000})
+    {
+        AlgInt fact, binom, prim;
+        auto t1 = STOPWATCH_NOW;
+        AlgInt::factorial(n, fact);
+        auto t2 = STOPWATCH_NOW;
+        AlgInt::binomial(n, n/2, binom);
+        auto t3 = STOPWATCH_NOW;
+        AlgInt::primorial(n, prim);
+        auto t4 = STOPWATCH_NOW;
+
+        std::cout << "n = " << n << " (n! has " << fact.get_bitsize() << " bits):\n";
+
+        //* One small factor at a time (quadratic, so only for the smaller n).
+        if (n <= 100000)
+        {
+            AlgInt naive = 1;
+            auto t5 = STOPWATCH_NOW;
+            for (uint32_t i = 2; i <= n; i++)
+                AlgInt::mul(naive, i, naive);
+            auto t6 = STOPWATCH_NOW;
+            std::cout << "\toperator*=: " << std::chrono::duration_cast<std::chrono::milliseconds>(t6-t5).count() << " ms\n";
+            std::cout << "\tfactorial:  " << std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count() << " ms";
+            std::cout << ((naive == fact) ? "" : " (MISMATCH)") << '\n';
+        }
+        else
+            std::cout << "\tfactorial:  " << std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count() << " ms\n";
+
+        std::cout << "\tbinomial:   " << std::chrono::duration_cast<std::chrono::milliseconds>(t3-t2).count() << " ms (C(n, n/2))\n";
+        std::cout << "\tprimorial:  " << std::chrono::duration_cast<std::chrono::milliseconds>(t4-t3).count() << " ms\n";
+    }
+    std::cout << '\n';
 }
 
 void rsa_example(size_t bitsize)
@@ -590,13 +1384,13 @@ void rsa_example(size_t bitsize)
     AlgInt temp;
     std::cout << "P stats:\n";
     auto p_time1 = STOPWATCH_NOW;
-    AlgInt P = gen_prime(bitsize);
+    AlgInt P = AlgInt::random_prime(bitsize, (u32rand) rand);
     auto p_time2 = STOPWATCH_NOW;
     std::cout << "Time took: " << std::chrono::duration_cast<std::chrono::milliseconds>(p_time2-p_time1).count() << " ms\n\n";
 
     std::cout << "Q stats:\n";
     auto q_time1 = STOPWATCH_NOW;
-    AlgInt Q = gen_prime(bitsize);
+    AlgInt Q = AlgInt::random_prime(bitsize, (u32rand) rand);
     auto q_time2 = STOPWATCH_NOW;
     std::cout << "Time took: " << std::chrono::duration_cast<std::chrono::milliseconds>(q_time2-q_time1).count() << " ms\n\n";
 
@@ -639,63 +1433,63 @@ void rsa_example(size_t bitsize)
     std::cout << "Encrypted: " << message << "\n";
     std::cout << "Enc Time: " << std::chrono::duration_cast<std::chrono::milliseconds>(enc_time2-enc_time1).count() << " ms\n\n";
 
+    // CRT private key: (P, Q, dp, dq, q_inv)
+    AlgInt dp = d % (P-1);
+    AlgInt dq = d % (Q-1);
+    AlgInt q_inv;
+    AlgInt::mod_inv(Q, P, q_inv);
+    AlgInt crt_message, crt_thread_message;
+
+    auto crt_time1 = STOPWATCH_NOW;
+    AlgInt::rsa_crt(message, P, Q, dp, dq, q_inv, crt_message);
+    auto crt_time2 = STOPWATCH_NOW;
+    AlgInt::rsa_crt(message, P, Q, dp, dq, q_inv, crt_thread_message, true);
+    auto crt_time3 = STOPWATCH_NOW;
+
     auto dec_time1 = STOPWATCH_NOW;
     AlgInt::mod_exp(message, d, n, message);
     auto dec_time2 = STOPWATCH_NOW;
     std::cout << "Decrypted: " << message << "\n";
     std::cout << "Dec Time: " << std::chrono::duration_cast<std::chrono::milliseconds>(dec_time2-dec_time1).count() << " ms\n\n";
-}
-
 
+    std::cout << "Decrypted (CRT): " << crt_message << "\n";
+    std::cout << "CRT Dec Time: " << std::chrono::duration_cast<std::chrono::milliseconds>(crt_time2-crt_time1).count() << " ms\n";
+    std::cout << "CRT Dec Time (2 threads): " << std::chrono::duration_cast<std::chrono::milliseconds>(crt_time3-crt_time2).count() << " ms\n";
+    std::cout << "Results match: " << ((crt_message == message && crt_thread_message == message) ? "yes" : "NO") << "\n\n";
+}
 
-// Short prime size is arbitrary.
-constexpr uint32_t short_primes[1000] = {3,5,7,11,13,17,19,23,29,31,37,41,43,47,53,59,61,67,71,73,79,83,89,97,101,103,107,109,113,127,131,137,139,149,151,157,163,167,173,179,181,191,193,197,199,211,223,227,229,233,239,241,251,257,263,269,271,277,281,283,293,307,311,313,317,331,337,347,349,353,359,367,373,379,383,389,397,401,409,419,421,431,433,439,443,449,457,461,463,467,479,487,491,499,503,509,521,523,541,547,557,563,569,571,577,587,593,599,601,607,613,617,619,631,641,643,647,653,659,661,673,677,683,691,701,709,719,727,733,739,743,751,757,761,769,773,787,797,809,811,821,823,827,829,839,853,857,859,863,877,881,883,887,907,911,919,929,937,941,947,953,967,971,977,983,991,997,1009,1013,1019,1021,1031,1033,1039,1049,1051,1061,1063,1069,1087,1091,1093,1097,1103,1109,1117,1123,1129,1151,1153,1163,1171,1181,1187,1193,1201,1213,1217,1223,1229,1231,1237,1249,1259,1277,1279,1283,1289,1291,1297,1301,1303,1307,1319,1321,1327,1361,1367,1373,1381,1399,1409,1423,1427,1429,1433,1439,1447,1451,1453,1459,1471,1481,1483,1487,1489,1493,1499,1511,1523,1531,1543,1549,1553,1559,1567,1571,1579,1583,1597,1601,1607,1609,1613,1619,1621,1627,1637,1657,1663,1667,1669,1693,1697,1699,1709,1721,1723,1733,1741,1747,1753,1759,1777,1783,1787,1789,1801,1811,1823,1831,1847,1861,1867,1871,1873,1877,1879,1889,1901,1907,1913,1931,1933,1949,1951,1973,1979,1987,1993,1997,1999,2003,2011,2017,2027,2029,2039,2053,2063,2069,2081,2083,2087,2089,2099,2111,2113,2129,2131,2137,2141,2143,2153,2161,2179,2203,2207,2213,2221,2237,2239,2243,2251,2267,2269,2273,2281,2287,2293,2297,2309,2311,2333,2339,2341,2347,2351,2357,2371,2377,2381,2383,2389,2393,2399,2411,2417,2423,2437,2441,2447,2459,2467,2473,2477,2503,2521,2531,2539,2543,2549,2551,2557,2579,2591,2593,2609,2621,2617,2633,2647,2657,2659,2663,2671,2677,2683,2687,2689,2693,2699,2707,2711,2713,2719,2729,2731,2741,2749,2753,2767,2777,2789,2791,2797,2801,2803,2819,2833,2837,2843,2851,2857,2861,2879,2887,2897,2903,2909,2917,2927,2939,2953,2957,2963,2969,2971,2999,3001,3011,3019,3023,3037,3041,3049,3061,3067,3079,3083,3089,3109,3119,3121,3137,3163,3167,3169,3181,3187,3191,3203,3209,3217,3221,3229,3251,3253,3257,3259,3271,3299,3301,3307,3313,3319,3323,3329,3331,3343,3347,3359,3361,3371,3373,3389,3391,3407,3413,3433,3449,3457,3461,3463,3467,3469,3491,3499,3511,3517,3527,3529,3533,3539,3541,3547,3557,3559,3571,3581,3583,3593,3607,3613,3617,3623,3631,3637,3643,3659,3671,3673,3677,3691,3697,3701,3709,3719,3727,3733,3739,3761,3767,3769,3779,3793,3797,3803,3821,3823,3833,3847,3851,3853,3863,3877,3881,3889,3907,3911,3917,3919,3923,3929,3931,3943,3947,3967,3989,4001,4003,4007,4013,4019,4021,4027,4049,4051,4057,4073,4079,4091,4093,4099,4111,4127,4129,4133,4139,4153,4157,4159,4177,4201,4211,4217,4219,4229,4231,4241,4243,4253,4259,4261,4271,4273,4283,4289,4297,4327,4337,4339,4349,4357,4363,4373,4391,4397,4409,4421,4423,4441,4447,4451,4457,4463,4481,4483,4493,4507,4513,4517,4519,4523,4547,4549,4561,4567,4583,4591,4597,4603,4621,4637,4639,4643,4649,4651,4657,4663,4673,4679,4691,4703,4721,4723,4729,4733,4751,4759,4783,4787,4789,4793,4799,4801,4813,4817,4831,4861,4871,4877,4889,4903,4909,4919,4931,4933,4937,4943,4951,4957,4967,4969,4973,4987,4993,4999,5003,5009,5011,5021,5023,5039,5051,5059,5077,5081,5087,5099,5101,5107,5113,5119,5147,5153,5167,5171,5179,5189,5197,5209,5227,5231,5233,5237,5261,5273,5279,5281,5297,5303,5309,5323,5333,5347,5351,5381,5387,5393,5399,5407,5413,5417,5419,5431,5437,5441,5443,5449,5471,5477,5479,5483,5501,5503,5507,5519,5521,5527,5531,5557,5563,5569,5573,5581,5591,5623,5639,5641,5647,5651,5653,5657,5659,5669,5683,5689,5693,5701,5711,5717,5737,5741,5743,5749,5779,5783,5791,5801,5807,5813,5821,5827,5839,5843,5849,5851,5857,5861,5867,5869,5879,5881,5897,5903,5923,5927,5939,5953,5981,5987,6007,6011,6029,6037,6043,6047,6053,6067,6073,6079,6089,6091,6101,6113,6121,6131,6133,6143,6151,6163,6173,6197,6199,6203,6211,6217,6221,6229,6247,6257,6263,6269,6271,6277,6287,6299,6301,6311,6317,6323,6329,6337,6343,6353,6359,6361,6367,6373,6379,6389,6397,6421,6427,6449,6451,6469,6473,6481,6491,6521,6529,6547,6551,6553,6563,6569,6571,6577,6581,6599,6607,6619,6637,6653,6659,6661,6673,6679,6689,6691,6701,6703,6709,6719,6733,6737,6761,6763,6779,6781,6791,6793,6803,6823,6827,6829,6833,6841,6857,6863,6869,6871,6883,6899,6907,6911,6917,6947,6949,6959,6961,6967,6971,6977,6983,6991,6997,7001,7013,7019,7027,7039,7043,7057,7069,7079,7103,7109,7121,7127,7129,7151,7159,7177,7187,7193,7207,7211,7213,7219,7229,7237,7243,7247,7253,7283,7297,7307,7309,7321,7331,7333,7349,7351,7369,7393,7411,7417,7433,7451,7457,7459,7477,7481,7487,7489,7499,7507,7517,7523,7529,7537,7541,7547,7549,7559,7561,7573,7577,7583,7589,7591,7603,7607,7621,7639,7643,7649,7669,7673,7681,7687,7691,7699,7703,7717,7723,7727,7741,7753,7757,7759,7789,7793,7817,7823,7829,7841,7853,7867,7873,7877,7879,7883,7901,7907,7919,7927};
 
-AlgInt gen_prime(size_t bitsize)
+void multi_prime_rsa_timing(size_t bitsize)
 {
-    // Note that all witnesses are user-provided. All randomness is either user-generated
-    // or user-provided (in the form of rand_function pointers as input).
-    size_t witnesses_checked = 0;
+    std::cout << "\n---Multi-Prime RSA (" << bitsize << ")---\n";
 
-    // Bitsize is expected to be a power of two.
-    AlgInt prime = {bitsize/32, (u32rand)rand, false};
-    AlgInt const_wit = 2;
-    
-    // Force prime to be odd, and forces prime to be at least bitsize bits long. 
-    prime.set_bit(0);
-    prime.set_bit(prime.get_size()*32-1);
-    
-    retry:
-    AlgInt::add(prime, 2, prime);
-
-    // Trial short prime divide
-    for (size_t i = 0; i < (sizeof(short_primes)/sizeof(short_primes[0])); i++)
+    for (size_t prime_count = 2; prime_count <= 4; prime_count++)
     {
-        if (AlgInt::mod(prime, short_primes[i]) == 0)
-            goto retry;
-    }
+        const size_t rounds = 5;
+        RSAKey key;
 
-    //! Total AlgInts checked by miller-rabin
+        auto key_time1 = STOPWATCH_NOW;
+        AlgInt::rsa_keygen(bitsize, prime_count, (u32rand) rand, key);
+        auto key_time2 = STOPWATCH_NOW;
 
-    // const witness miller-rabin (prevents rand() waste)
-    witnesses_checked++;
-    while (AlgInt::miller_rabin(prime, const_wit) == false)
-        goto retry;
+        AlgInt message = AlgInt(bitsize/32, (u32rand) rand) % key.n;
+        AlgInt full, single, threaded;
 
-    // Random witness miller-rabin (24 loops)
-    // est. probability of false prime: 4**(-24)
-    // Since we do not allow for ALL valid witnesses (which is a requirement of miller-rabin), 
-    // the probability is likely much higher for a false prime.
-    for (size_t i = 0; i < 24; i++)
-    {
-        witnesses_checked++;
-        AlgInt rand_wit = {bitsize/64, (u32rand)rand, false};
-        if (AlgInt::miller_rabin(prime, rand_wit) == false)
-            goto retry;
+        auto t1 = STOPWATCH_NOW;
+        AlgInt::mod_exp(message, key.d, key.n, full);
+        auto t2 = STOPWATCH_NOW;
+        for (size_t i = 0; i < rounds; i++)
+            AlgInt::rsa_private(message, key, single);
+        auto t3 = STOPWATCH_NOW;
+        for (size_t i = 0; i < rounds; i++)
+            AlgInt::rsa_private(message, key, threaded, true);
+        auto t4 = STOPWATCH_NOW;
+
+        std::cout << "Primes: " << prime_count << '\n';
+        std::cout << "Keygen Time: " << std::chrono::duration_cast<std::chrono::milliseconds>(key_time2-key_time1).count() << " ms\n";
+        std::cout << "mod_exp Time: " << std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count() << " ms\n";
+        std::cout << "rsa_private Time: " << std::chrono::duration_cast<std::chrono::milliseconds>(t3-t2).count()/rounds << " ms\n";
+        std::cout << "rsa_private Time (threaded): " << std::chrono::duration_cast<std::chrono::milliseconds>(t4-t3).count()/rounds << " ms\n";
+        std::cout << "Results match: " << ((full == single && full == threaded) ? "yes" : "NO") << "\n\n";
     }
-
-    // Potential primes here refers to primes that have passed trial divison.
-    // So these are only the primes which are tested by the miller-rabin test.
-    std::cout << "Total potential primes checked: " << witnesses_checked << '\n';
-    return prime;
-}
\ No newline at end of file
+}
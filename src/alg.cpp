@@ -26,24 +26,9 @@ AlgInt AlgInt::gcd(const AlgInt& a, const AlgInt& b)
 
 AlgInt AlgInt::lcm(const AlgInt& x, const AlgInt& y)
 {
-    //* lcm(x,y) = |x*y| / gcd(x,y)
-    return abs(x * y) / gcd(x, y);
-}
-
-void AlgInt::mod_inv(const AlgInt& x, const AlgInt& m, AlgInt& inv)
-{
-    //* The modular multiplicative inverse of a number can be calculated
-    //*  with the ext_gcd algorithm, provided that gcd(x, m) == 1.
-    AlgInt temp, gcd;
-    gcd = ext_gcd(x, m, inv, temp);
-
-    if (cmp(gcd, 1) != 0)
-        throw std::domain_error("x^-1 (mod m) does not exist for provided x and m. x^-1 only exists if gcd(x, m) == 1.");
-
-    //* Inv might be returned negative by ext_gcd (-inv == inv - m (mod m)). For convenience, only
-    //*  positive values of inv are returned, although both are valid inverses under modulo.
-    if (inv.sign)
-        add(inv, m, inv);
+    //* lcm(x,y) = |x*y| / gcd(x,y), where the gcd divides |x*y| exactly.
+    AlgInt temp;
+    div_exact(abs(x * y), gcd(x, y), temp);
 
-    return;
+    return temp;
 }
\ No newline at end of file
@@ -0,0 +1,119 @@
+/**
+*   File: batch_gcd.cpp
+*   Project: Alginate
+*   SPDX-License-Identifier: Unlicense
+*
+*   Bernstein's batch GCD finds every modulus n_i that shares a factor with any
+*   other modulus of a set, without computing the gcd of every pair. Let P be
+*   the product of all moduli. Then P/n_i is the product of every other modulus,
+*   and gcd(n_i, P/n_i) is the shared part of n_i. Because
+*   (P mod n_i^2) / n_i == (P/n_i) mod n_i, this gcd only involves numbers as
+*   large as n_i.
+*
+*   P is computed with a product tree: the leaves are the moduli, and every node
+*   is the product of its two children (an odd node out is carried up alone).
+*   P mod n_i^2 is computed with a remainder tree, from the root down: every
+*   node is its parent's remainder, reduced modulo the square of the node's own
+*   product tree value. Each reduction shrinks the remainder to twice the size
+*   of the node, so no leaf ever divides the full P. The multiplications at the
+*   top of the tree are very large, which is where Karatsuba multiplication
+*   (see mul.cpp) pays off.
+*
+*   The nodes of a tree level are independent of each other, so every level may
+*   be spread across worker threads, which take nodes from a shared atomic index.
+*/
+#include "Alginate.hpp"
+#include <atomic>
+#include <thread>
+
+// Calls func(i) for every i in [0, count), spread across thread_count threads.
+template <typename Func>
+static void parallel_for(size_t count, size_t thread_count, Func func)
+{
+    std::atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        for (size_t i = next++; i < count; i = next++)
+            func(i);
+    };
+
+    //* The calling thread is one of the workers.
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < thread_count && i < count; i++)
+        workers.emplace_back(worker);
+    worker();
+    for (std::thread& thread : workers)
+        thread.join();
+
+    return;
+}
+
+void AlgInt::batch_gcd(const std::vector<AlgInt>& moduli, std::vector<AlgInt>& ret, size_t thread_count)
+{
+    //? Exception block
+    //* The workers must never throw, so every modulus is checked up front.
+    for (const AlgInt& n : moduli)
+    {
+        if (n.sign || n.size == 0)
+            throw std::domain_error("Moduli must be positive.");
+    }
+    if (thread_count == 0)
+        thread_count = 1;
+
+    std::vector<AlgInt> tret(moduli.size());
+    if (moduli.empty())
+    {
+        std::swap(ret, tret);
+        return;
+    }
+
+    //? Product tree (tree[0] holds the moduli, tree.back() holds P)
+    std::vector<std::vector<AlgInt>> tree;
+    tree.push_back(moduli);
+    while (tree.back().size() > 1)
+    {
+        const std::vector<AlgInt>& below = tree.back();
+        std::vector<AlgInt> level((below.size() + 1) / 2);
+
+        parallel_for(level.size(), thread_count, [&](size_t i)
+        {
+            if (2*i + 1 < below.size())
+                mul(below[2*i], below[2*i + 1], level[i]);
+            else
+                level[i] = below[2*i];
+        });
+
+        tree.push_back(std::move(level));
+    }
+
+    //? Remainder tree (each node becomes its parent's remainder mod the node squared)
+    //* A single modulus is its own root, so P mod n^2 == n.
+    if (tree.size() == 1)
+        tret[0] = moduli[0];
+    for (size_t depth = tree.size() - 1; depth-- > 0;)
+    {
+        std::vector<AlgInt>& level = tree[depth];
+        const std::vector<AlgInt>& above = tree[depth + 1];
+
+        parallel_for(level.size(), thread_count, [&](size_t i)
+        {
+            AlgInt sqr;
+            mul(level[i], level[i], sqr);
+
+            // Leaves keep n_i for the final gcd, and store their remainder in tret.
+            AlgInt& rem = (depth) ? level[i] : tret[i];
+            mod(above[i/2], sqr, rem);
+        });
+    }
+
+    //? gcd(n_i, (P mod n_i^2) / n_i)
+    parallel_for(moduli.size(), thread_count, [&](size_t i)
+    {
+        div_exact(tret[i], moduli[i], tret[i]);
+        gcd(moduli[i], tret[i], tret[i]);
+    });
+
+    // Return values
+    std::swap(ret, tret);
+    return;
+}
@@ -0,0 +1,137 @@
+/**
+*   File: batch_mod_inv.cpp
+*   Project: Alginate
+*   SPDX-License-Identifier: Unlicense
+*
+*   Montgomery's trick inverts n elements modulo the same m with a single
+*   modular inversion. The prefix products c_i = a_0 * a_1 * ... * a_i are
+*   computed first, and only the final product is inverted. Walking back
+*   down, every inverse is peeled off of the inverse of a prefix:
+*
+*       a_i^-1     = c_i^-1 * c_(i-1)
+*       c_(i-1)^-1 = c_i^-1 * a_i
+*
+*   This costs 3(n-1) modular multiplications and one mod_inv(), instead of n
+*   calls to mod_inv().
+*
+*   For an odd m, the multiplications are Montgomery products xy * R^-1,
+*   performed directly on the elements without converting them into
+*   Montgomery space. The prefix c_i then carries a factor of R^-i, which the
+*   back substitution removes again: the inverse of c_(n-1) carries R^(n-1),
+*   and every step down multiplies by R^-1, so that each a_i^-1 comes out
+*   exact.
+*
+*   Elements that are zero (mod m) are the only ones without an inverse for a
+*   prime m. They are known after the reduction, so they receive a zero up
+*   front, and are replaced by 1 (R in Montgomery form) in the prefix chain,
+*   which passes the prefix through unchanged.
+*
+*   Any other element can only share a factor with a composite m. Then so does
+*   the whole product, and the single inversion fails. The batch is then split
+*   in half and each half is retried, which isolates every failing element in
+*   O(log n) retries without giving up on the invertible elements. The prefix
+*   products of the left half are still valid, so only the right half is
+*   multiplied again. Failing elements receive a zero as well.
+*/
+#include "Alginate.hpp"
+#include <memory>
+
+// ret = x * y (mod m) for an even m, or the Montgomery product x * y * R^-1 (mod m) for an odd m.
+static void batch_mul(const AlgInt& x, const AlgInt& y, const AlgInt& m, const MontgomeryContext* ctx, AlgInt& ret)
+{
+    if (ctx)
+        ctx->mul(x, y, ret);
+    else
+        AlgInt::mod_mul(x, y, m, ret);
+
+    return;
+}
+
+// out[i] = a[i]^-1 (mod m) for i in [first, last). The prefix products are reused if they are already valid from first.
+static void batch_range(const std::vector<AlgInt>& a, const AlgInt& m, const MontgomeryContext* ctx, size_t first, size_t last, bool has_prefix, std::vector<AlgInt>& prefix, std::vector<AlgInt>& out)
+{
+    //? prefix[i] = a[first] * ... * a[i] (mod m)
+    if (!has_prefix)
+    {
+        prefix[first] = a[first];
+        for (size_t i = first + 1; i < last; i++)
+            batch_mul(prefix[i-1], a[i], m, ctx, prefix[i]);
+    }
+
+    //? A single inversion of the whole product
+    AlgInt inv;
+    try
+    {
+        AlgInt::mod_inv(prefix[last-1], m, inv);
+    }
+    catch (const std::domain_error&)
+    {
+        //* At least one element has no inverse, which halving isolates.
+        if (last - first == 1)
+        {
+            out[first] = 0;
+            return;
+        }
+
+        size_t mid = first + (last - first) / 2;
+        batch_range(a, m, ctx, first, mid, true, prefix, out);
+        batch_range(a, m, ctx, mid, last, false, prefix, out);
+        return;
+    }
+
+    //? Back substitution, where inv = (a[first] * ... * a[i])^-1
+    for (size_t i = last - 1; i > first; i--)
+    {
+        batch_mul(inv, prefix[i-1], m, ctx, out[i]);
+        batch_mul(inv, a[i], m, ctx, inv);
+    }
+    std::swap(inv, out[first]);
+
+    return;
+}
+
+void AlgInt::batch_mod_inv(const std::vector<AlgInt>& in, const AlgInt& m, std::vector<AlgInt>& out)
+{
+    //? Exception block
+    if (m.sign || m.size == 0)
+        throw std::domain_error("Signed or zero m not supported.");
+
+    //* Montgomery products for odd moduli, plain modular multiplication otherwise.
+    std::unique_ptr<MontgomeryContext> ctx;
+    if (m.num[0] & 1)
+        ctx = std::make_unique<MontgomeryContext>(m);
+
+    // Reduced copies of the elements (which also allows out to overlap with in).
+    std::vector<AlgInt> a(in.size());
+    std::vector<bool> zero(in.size(), false);
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        mod(in[i], m, a[i]);
+        if (a[i].sign)
+            add(a[i], m, a[i]);
+
+        //* Zeros never have an inverse, and 1 leaves the prefix unchanged.
+        if (a[i].size == 0)
+        {
+            zero[i] = true;
+            a[i] = (ctx) ? ctx->one() : AlgInt(1);
+        }
+    }
+
+    std::vector<AlgInt> prefix(in.size()), tret(in.size());
+    if (in.size())
+        batch_range(a, m, ctx.get(), 0, in.size(), false, prefix, tret);
+
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        //* Montgomery products are lazily reduced into [0, 2m).
+        if (zero[i])
+            tret[i] = 0;
+        else if (ctx)
+            ctx->reduce(tret[i]);
+    }
+
+    // Return values
+    std::swap(out, tret);
+    return;
+}
@@ -138,14 +138,14 @@ void AlgInt::bw_shr(const AlgInt& x, size_t y, AlgInt& ret)
     size_t dig_shift = y>>5;
     size_t bit_shift = y & 0x1F;
 
+    // If we clear x with digit shift alone, return early.
+    if (dig_shift >= x.size)
+        return (void) (ret = 0);
+
     AlgInt temp;
     temp.resize(x.size - dig_shift);
     temp.sign = x.sign;
 
-    // If we clear x with digit shift alone, return early.
-    if (dig_shift > x.size)
-        return (void) (ret = 0);
-
     // Copy x into temp (accounting for digit shift).
     for (size_t i = 0; i < temp.size; i++)
         temp.num[i] = x.num[i+dig_shift];
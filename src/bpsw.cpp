@@ -0,0 +1,162 @@
+/**
+*   File: bpsw.cpp
+*   Project: Alginate
+*   SPDX-License-Identifier: Unlicense
+*
+*   The Baillie-PSW test combines a base 2 Miller-Rabin test with a strong
+*   Lucas probable prime test. The pseudoprimes of the two tests appear to be
+*   disjoint (none below 2^64 exist, and no counterexample is known), which
+*   gives more assurance than many rounds of Miller-Rabin at the cost of about
+*   three exponentiations.
+*
+*   The Lucas sequences U_k and V_k with parameters P and Q are defined by
+*   U_0 = 0, U_1 = 1, V_0 = 2, V_1 = P and X_(k+1) = P*X_k - Q*X_(k-1). We use
+*   Selfridge's method: D is the first of 5, -7, 9, -11, 13, ... for which the
+*   Jacobi symbol (D/n) == -1, with P = 1 and Q = (1 - D)/4. If n is prime,
+*   then U_(n+1) == 0 (mod n). Like Miller-Rabin, the strong test splits
+*   n + 1 = d * 2^s, and n is a strong Lucas probable prime if U_d == 0 or
+*   V_(d*2^r) == 0 (mod n) for some r in [0, s).
+*
+*   U_d and V_d are computed from the most significant bit of d down with the
+*   doubling formulas U_2k = U_k*V_k, V_2k = V_k^2 - 2Q^k, and the increment
+*   formulas U_(k+1) = (P*U_k + V_k)/2, V_(k+1) = (D*U_k + P*V_k)/2. Every
+*   value (including D and Q) is kept in Montgomery form. Halving is exact in
+*   Montgomery form too, since (x*R)/2 == (x/2)*R (mod n): an odd x has n added
+*   before it is shifted.
+*
+*   Because (D/n) is never -1 when n is a perfect square, a perfect square would
+*   never find its D. n is checked for squareness after a few failed values of D.
+*/
+#include "Alginate.hpp"
+
+// Candidate D values tried before n is checked for being a perfect square.
+constexpr size_t SQUARE_CHECK_AFTER = 8;
+
+// ret = x (mod n) in Montgomery form, for a small signed x.
+static void small_to_mont(const MontgomeryContext& ctx, int64_t x, AlgInt& ret)
+{
+    AlgInt abs_x = (uint64_t) ((x < 0) ? -x : x);
+    ctx.to_mont(abs_x, ret);
+
+    //* -x == n - x (mod n)
+    if (x < 0 && AlgInt::cmp(ret, 0) != 0)
+        AlgInt::sub(ctx.get_mod(), ret, ret);
+
+    return;
+}
+
+// x = x/2 (mod n) in place. x is fully reduced first.
+static void half_mod(const MontgomeryContext& ctx, AlgInt& x)
+{
+    ctx.reduce(x);
+    if (x.get_bit(0))
+        AlgInt::add(x, ctx.get_mod(), x);
+    AlgInt::bw_shr(x, 1, x);
+
+    return;
+}
+
+// Returns true if x is zero (mod n), for a lazily reduced x.
+static bool is_zero(const MontgomeryContext& ctx, AlgInt& x)
+{
+    ctx.reduce(x);
+    return AlgInt::cmp(x, 0) == 0;
+}
+
+bool AlgInt::is_probable_prime_bpsw(const AlgInt& n)
+{
+    //? Small and even n
+    if (n.sign || cmp(n, 2) < 0)
+        return false;
+    if (cmp(n, 4) < 0)
+        return true;
+    if ((n.num[0] & 1) == 0)
+        return false;
+
+    //* Below 2^64 (where no BPSW pseudoprime exists) the native deterministic test is exact.
+    if (n.size <= 2)
+        return is_prime_u64(n.output_uint64());
+
+    //? Miller-Rabin (base 2)
+    if (!miller_rabin(n, 2))
+        return false;
+
+    //? Selfridge's method A: D = 5, -7, 9, -11, ... until (D/n) == -1
+    int64_t d = 5;
+    for (size_t tries = 1; ; tries++)
+    {
+        int jac = jacobi(AlgInt((uint64_t) ((d < 0) ? -d : d), d < 0), n);
+        if (jac == -1)
+            break;
+
+        //* (D/n) == 0 means D shares a factor with n (n is composite, unless n == |D|).
+        if (jac == 0 && cmp(n, (int32_t) ((d < 0) ? -d : d)) != 0)
+            return false;
+
+        if (tries == SQUARE_CHECK_AFTER)
+        {
+            AlgInt root, rem;
+            isqrt_rem(n, root, rem);
+            if (rem.size == 0)
+                return false;
+        }
+
+        d = (d < 0) ? -d + 2 : -(d + 2);
+    }
+
+    //? Strong Lucas probable prime test (P = 1, Q = (1 - D)/4)
+    MontgomeryContext ctx(n);
+    AlgInt d_mont, q_mont, temp;
+    small_to_mont(ctx, d, d_mont);
+    small_to_mont(ctx, (1 - d) / 4, q_mont);
+
+    // n + 1 = k * 2^s
+    AlgInt k;
+    add(n, 1, k);
+    size_t s = 0;
+    while (k.get_bit(s) == 0)
+        s++;
+    bw_shr(k, s, k);
+
+    // U_1 = 1, V_1 = P = 1, Q^1 = Q
+    AlgInt u = ctx.one(), v = ctx.one(), qk = q_mont;
+
+    //? Primary Lucas chain (MSB first, the leading bit is U_1 / V_1 itself)
+    for (size_t i = k.get_bitsize() - 1; i-- > 0;)
+    {
+        // U_2k = U_k*V_k, V_2k = V_k^2 - 2Q^k, Q^2k = (Q^k)^2
+        ctx.mul(u, v, u);
+        ctx.mul(v, v, v);
+        ctx.sub(v, qk, v);
+        ctx.sub(v, qk, v);
+        ctx.mul(qk, qk, qk);
+
+        if (k.get_bit(i))
+        {
+            // U_(k+1) = (U_k + V_k)/2, V_(k+1) = (D*U_k + V_k)/2, Q^(k+1) = Q^k * Q
+            ctx.mul(d_mont, u, temp);
+            ctx.add(u, v, u);
+            ctx.add(temp, v, v);
+            half_mod(ctx, u);
+            half_mod(ctx, v);
+            ctx.mul(qk, q_mont, qk);
+        }
+    }
+
+    //* U_d == 0 or V_d == 0
+    if (is_zero(ctx, u) || is_zero(ctx, v))
+        return true;
+
+    // V_(d*2^r) == 0 for any r in [1, s)
+    for (size_t r = 1; r < s; r++)
+    {
+        ctx.mul(v, v, v);
+        ctx.sub(v, qk, v);
+        ctx.sub(v, qk, v);
+        if (is_zero(ctx, v))
+            return true;
+        ctx.mul(qk, qk, qk);
+    }
+
+    return false;
+}
@@ -37,10 +37,17 @@ void AlgInt::div(const AlgInt& x, const AlgInt& y, AlgInt& quotient, AlgInt& rem
     // If y.size == 1, perform quick division
     if (y.size == 1)
     {
+        //* Signs are read first, because quotient or remainder may overlap with x or y.
+        bool q_sign = (x.sign ^ y.sign) && !unsign;
+        bool r_sign = x.sign && !unsign;
+
         // AlgInt y is cast into uint32_t
-        remainder = div(x, y.num[0], quotient, true);
-        quotient.sign = (x.sign ^ y.sign) && !unsign;
-        remainder.sign = (x.sign) && !unsign;
+        int64_t rem = div(x, y.num[0], quotient, true);
+        remainder = (uint64_t) ((rem < 0) ? -rem : rem);
+
+        // Canonical zero is positive.
+        quotient.sign = q_sign && quotient.size;
+        remainder.sign = r_sign && remainder.size;
 
         return;
     }
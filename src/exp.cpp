@@ -19,9 +19,38 @@
 *   we also reduce the result modulo m. This works because modular multiplication
 *   is "distributive": (x * y) mod m == (x mod m) * (y mod m). Distributive is likely
 *   the wrong word but adequately explains the relationship.
+*
+*   Moduli just below a power of two (see special_mod.cpp) skip both division
+*   and Montgomery space, since their reductions only need shifts and additions.
+*
+*   Short exponents (at most 64 bits, such as the RSA public exponent 65537) only
+*   need a handful of multiplications, far fewer than the ext_gcd and divisions
+*   required to set up Montgomery space. These are instead computed left to right
+*   (square, then multiply by the unchanging base if the bit is set), which is the
+*   binary addition chain for the exponent, and reduced with Barrett reduction.
+*   Barrett reduction replaces the division by m with two multiplications by the
+*   precomputed mu = floor(2^2k / m), where k is the bitsize of m:
+*   q = ((x >> (k-1)) * mu) >> (k+1) underestimates x / m by at most 2, so
+*   x - q*m only requires up to two final subtractions.
 */
 #include "Alginate.hpp"
 
+// Reduces 0 <= x < 2^2k modulo m, where k = bitsize(m) and mu = floor(2^2k / m).
+static void barrett_redc(AlgInt& x, const AlgInt& m, const AlgInt& mu, size_t k, AlgInt& temp)
+{
+    AlgInt::bw_shr(x, k-1, temp);
+    AlgInt::mul(temp, mu, temp);
+    AlgInt::bw_shr(temp, k+1, temp);
+    AlgInt::mul(temp, m, temp);
+    AlgInt::sub(x, temp, x);
+
+    //* At most two corrections are required.
+    while (AlgInt::cmp(x, m) >= 0)
+        AlgInt::sub(x, m, x);
+
+    return;
+}
+
 void AlgInt::exp(const AlgInt& x, const AlgInt& y, AlgInt& ret, bool unsign)
 {
     // Exception block
@@ -56,6 +85,62 @@ void AlgInt::mod_exp(const AlgInt& x, const AlgInt& y, const AlgInt& m, AlgInt&
     if (y.sign)
         throw std::domain_error("Negative y not supported.");
 
+    // If modulus has a special form, we can reduce by folding (no divisions at all).
+    //* The modulus is classified once, and every product reuses it.
+    SpecialMod sm;
+    if (!x.sign && special_mod(m, sm))
+    {
+        AlgInt sqr;
+        mod(x, m, sqr);
+        AlgInt tret = 1;
+
+        for (size_t i = 0; i < y.get_bitsize(); i++)
+        {
+            // If the current bit is 1, multiply compounded x.
+            if (y.get_bit(i) == 1)
+                mod_mul(tret, sqr, sm, tret);
+
+            // sqr = sqr*sqr
+            mod_mul(sqr, sqr, sm, sqr);
+        }
+
+        // Return values
+        AlgInt::swap(tret, ret);
+        return;
+    }
+
+    // If the exponent is short, Montgomery setup would cost more than it saves.
+    if (y.size && y.size <= 2 && !m.sign)
+    {
+        size_t k = m.get_bitsize();
+        AlgInt base, mu, temp;
+        mod(x, m, base);
+
+        // mu = floor(2^2k / m)
+        mu.set_bit(2*k);
+        div(mu, m, mu);
+
+        //? Left-to-right binary exponentiation (MSB first, the leading bit is base itself)
+        AlgInt tret = base;
+        for (size_t i = y.get_bitsize() - 1; i-- > 0;)
+        {
+            // tret = tret*tret
+            mul(tret, tret, tret);
+            barrett_redc(tret, m, mu, k, temp);
+
+            // If the current bit is 1, multiply the base.
+            if (y.get_bit(i) == 1)
+            {
+                mul(tret, base, tret);
+                barrett_redc(tret, m, mu, k, temp);
+            }
+        }
+
+        // Return values
+        AlgInt::swap(tret, ret);
+        return;
+    }
+
     // If modulus is odd, we can use the montgomery optimization.
     if ((m.num[0] & 1) && !x.sign && !m.sign)
         return mont_exp(x, y, m, ret);
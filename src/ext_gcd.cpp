@@ -10,35 +10,205 @@
 *   allows a faster reduction over imbalanced integers over the more common
 *   gcd(a,b) == gcd(b, a-b) equivalence.
 *
+*   Every Euclid step costs a full division, even though most quotients are
+*   tiny. gcd() instead uses Lehmer's algorithm (see lehmer.cpp), which
+*   performs about 18 steps at once with a single pass over the digits, and
+*   only falls back to a division when a quotient is too large to simulate.
+*   Small operands use the binary gcd (Stein's algorithm) instead, which needs
+*   no division at all: gcd(a, b) == gcd(a - b, b), and factors of two are
+*   removed from the (even) difference since gcd(2x, y) == gcd(x, y) for an
+*   odd y. Each step is a subtraction and a shift by the count of trailing
+*   zeroes, performed in place on the digits of the two operands, so nothing
+*   is allocated. Lehmer's algorithm handles the leading digits of larger
+*   operands, until they are small enough for the binary gcd to finish.
+*   Operands that fit in 64 bits use the same algorithm on native integers.
+*
+*   Huge operands (of both gcd and ext_gcd) are first halved repeatedly with
+*   the subquadratic half-gcd (see hgcd.cpp).
+*
 *   The Extended GCD (or the Extended Euclidean Algorithm) calculates both
 *   the gcd and x,y where a*x + b*y = gcd(a,b). We use the afformentioned Extended
 *   Euclidean Algorithm to calculate these values. 
 */
 #include "Alginate.hpp"
+#include <algorithm>
+
+// Operands of at most this many digits are finished by the binary gcd.
+// Lehmer's algorithm is faster from 4 digits onwards.
+constexpr size_t BINARY_GCD_DIGITS = 3;
+
+// Operands above this many digits are first reduced with the half-gcd (see hgcd.cpp).
+// Lehmer's algorithm is faster for gcd() below this size.
+constexpr size_t HGCD_DIGITS = 8192;
+
+// ext_gcd() reduces operands above this many digits with the half-gcd. Its steps are tracked in a matrix,
+// which is far cheaper than the division per step of the Extended Euclidean Algorithm, even at a few digits.
+constexpr size_t EXT_HGCD_DIGITS = 2;
+
+// Binary gcd on native integers.
+static uint64_t gcd_u64(uint64_t a, uint64_t b)
+{
+    if (a == 0 || b == 0)
+        return a | b;
+
+    int shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    while (b)
+    {
+        b >>= __builtin_ctzll(b);
+        if (a > b)
+            std::swap(a, b);
+        b -= a;
+    }
+
+    return a << shift;
+}
+
+// Number of trailing zero bits of a non-zero x.
+static size_t ctz_digits(const uint32_t* x)
+{
+    size_t i = 0;
+    while (x[i] == 0)
+        i++;
+
+    return 32*i + __builtin_ctz(x[i]);
+}
+
+// Removes the trailing zero bits of x in place. Returns the new size of x.
+static size_t shr_ctz(uint32_t* x, size_t size)
+{
+    if (size == 0)
+        return 0;
+
+    size_t shift = ctz_digits(x);
+    size_t dig_shift = shift >> 5;
+    size_t bit_shift = shift & 0x1F;
+
+    //* Each digit is taken from a pair of digits, which avoids a (undefined) shift by 32.
+    size -= dig_shift;
+    for (size_t i = 0; i + 1 < size; i++)
+        x[i] = (uint32_t) ((((uint64_t) x[i + dig_shift + 1] << 32) | x[i + dig_shift]) >> bit_shift);
+    x[size-1] = x[size-1 + dig_shift] >> bit_shift;
+
+    while (size && x[size-1] == 0)
+        size--;
+    return size;
+}
+
+// x -= y in place, where x >= y. Returns the new size of x.
+static size_t sub_in_place(uint32_t* x, size_t x_size, const uint32_t* y, size_t y_size)
+{
+    uint32_t borrow = 0;
+    size_t i;
+    for (i = 0; i < y_size; i++)
+    {
+        uint64_t calc = (uint64_t) x[i] - y[i] - borrow;
+        x[i] = (uint32_t) calc;
+        borrow = (calc >> 32) & 1;
+    }
+    for (; borrow && i < x_size; i++)
+        borrow = (x[i]-- == 0);
+
+    while (x_size && x[x_size-1] == 0)
+        x_size--;
+    return x_size;
+}
+
+// Returns whether x >= y.
+static bool geq_digits(const uint32_t* x, size_t x_size, const uint32_t* y, size_t y_size)
+{
+    if (x_size != y_size)
+        return x_size > y_size;
+    for (size_t i = x_size; i-- > 0;)
+    {
+        if (x[i] != y[i])
+            return x[i] > y[i];
+    }
+
+    return true;
+}
+
+// Binary gcd of the odd x and y in place, where the larger operand is always replaced by the odd part of the difference.
+// Returns true if the result is left in x (y is zero), false if it is left in y.
+static bool binary_gcd(uint32_t* x, size_t& x_size, uint32_t* y, size_t& y_size)
+{
+    while (x_size && y_size)
+    {
+        //* The final 64 bits are finished with native integers.
+        if (x_size <= 2 && y_size <= 2)
+        {
+            uint64_t calc = gcd_u64(((uint64_t) ((x_size > 1) ? x[1] : 0) << 32) | x[0], ((uint64_t) ((y_size > 1) ? y[1] : 0) << 32) | y[0]);
+            x[0] = (uint32_t) calc;
+            x[1] = calc >> 32;
+            x_size = (x[1]) ? 2 : 1;
+            y_size = 0;
+            break;
+        }
+
+        if (geq_digits(x, x_size, y, y_size))
+            x_size = shr_ctz(x, sub_in_place(x, x_size, y, y_size));
+        else
+            y_size = shr_ctz(y, sub_in_place(y, y_size, x, x_size));
+    }
+
+    return y_size == 0;
+}
 
 void AlgInt::gcd(const AlgInt& a, const AlgInt& b, AlgInt& ret)
 {
     // big and sml need to be absolute here.
-    AlgInt big = (cmp(a, b) >= 0) ? a : b;
-    AlgInt sml = (cmp(a, b) >= 0) ? b : a;
+    AlgInt big = abs(a);
+    AlgInt sml = abs(b);
+    if (cmp(big, sml) < 0)
+        AlgInt::swap(big, sml);
 
     // Avoid divide by zero error.
-    if (cmp(a, 0) == 0 || cmp(b,0) == 0)
+    if (sml.size == 0)
         return AlgInt::swap(big, ret);
-    
-    //? Primary Euclidean Algorithm loop
+
+    //* Huge operands are first halved repeatedly by the half-gcd.
+    if (sml.size > HGCD_DIGITS)
+        hgcd_reduce(big, sml, HGCD_DIGITS, nullptr);
+
+    //? Primary Lehmer loop (until sml is small enough for the binary gcd)
+    CofactorMatrix mat;
     AlgInt temp;
-    while (cmp(sml, 0) != 0)
+    while (sml.size > BINARY_GCD_DIGITS)
     {
-        //* Since the remainder of a division is always smaller than the
-        //*  dividend, we can always swap big and sml until gcd(big, 0).
-        mod(big, sml, temp);
-        AlgInt::swap(sml, big);
-        AlgInt::swap(temp, sml);
+        //* Several Euclid steps at once, or a single full step if the
+        //*  quotient is too large to simulate.
+        if (lehmer_matrix(big, sml, mat))
+            apply_matrix(big, sml, mat);
+        else
+        {
+            mod(big, sml, temp);
+            AlgInt::swap(sml, big);
+            AlgInt::swap(temp, sml);
+        }
     }
-    
+
+    //* The binary gcd needs many steps to close a large size difference,
+    //*  which a single division does at once.
+    if (sml.size && big.size > sml.size + 1)
+        mod(big, sml, big);
+    if (big.size == 0 || sml.size == 0)
+        return AlgInt::swap((big.size) ? big : sml, ret);
+
+    //? The remaining steps fit in native integers.
+    if (big.size <= 2 && sml.size <= 2)
+    {
+        ret = gcd_u64(big.output_uint64(), sml.output_uint64());
+        return;
+    }
+
+    //? Binary gcd of the odd parts, in place on the digits of big and sml.
+    size_t shift = std::min(ctz_digits(big.num), ctz_digits(sml.num));
+    big.size = shr_ctz(big.num, big.size);
+    sml.size = shr_ctz(sml.num, sml.size);
+    bool in_big = binary_gcd(big.num, big.size, sml.num, sml.size);
+
     // Return values
-    AlgInt::swap(big, ret);
+    bw_shl((in_big) ? big : sml, shift, ret);
     return;
 }
 
@@ -52,6 +222,38 @@ AlgInt AlgInt::ext_gcd(const AlgInt& a, const AlgInt& b, AlgInt& x, AlgInt& y)
         return a;
     }
 
+    //? Huge operands are first reduced by the half-gcd, which accumulates its steps in M.
+    if (!a.sign && !b.sign && std::min(a.size, b.size) > EXT_HGCD_DIGITS)
+    {
+        bool swapped = cmp(a, b) < 0;
+        AlgInt big = (swapped) ? b : a;
+        AlgInt sml = (swapped) ? a : b;
+
+        HalfGcdMatrix mat;
+        hgcd_reduce(big, sml, EXT_HGCD_DIGITS, &mat);
+
+        //* With (big, sml) = M^-1 * (a, b) and big*x' + sml*y' = g:
+        //*  x = det * (x'*m11 - y'*m10), y = det * (y'*m00 - x'*m01)
+        AlgInt red_x, red_y, t0, t1;
+        AlgInt g = ext_gcd(big, sml, red_x, red_y);
+        mul(red_x, mat.m11, t0);
+        mul(red_y, mat.m10, t1);
+        sub(t0, t1, x);
+        mul(red_y, mat.m00, t0);
+        mul(red_x, mat.m01, t1);
+        sub(t0, t1, y);
+        if (mat.det < 0)
+        {
+            x.sign = !x.sign && x.size;
+            y.sign = !y.sign && y.size;
+        }
+
+        // Return values
+        if (swapped)
+            AlgInt::swap(x, y);
+        return g;
+    }
+
     // Extended Euclidean Algorithm (old_t and t are skipped).
     AlgInt old_r = a;
     AlgInt r = b;
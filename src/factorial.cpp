@@ -0,0 +1,175 @@
+/**
+*   File: factorial.cpp
+*   Project: Alginate
+*   SPDX-License-Identifier: Unlicense
+*
+*   Multiplying a growing result by one small factor at a time costs a pass
+*   over the whole result for every factor, which is quadratic in the size of
+*   the result. A product tree instead multiplies neighbouring values pairwise,
+*   level by level, so that both operands of every multiplication have about
+*   the same size. The large multiplications near the root of the tree are
+*   where Karatsuba multiplication (see mul.cpp) pays off. Small factors are
+*   first packed into 64-bit words with native multiplications.
+*
+*   The factorial uses Luschny's prime swing. The swing n!/((n/2)!)^2 (the
+*   central binomial coefficient, up to a factor of two) is the product of
+*   every prime p <= n raised to e = sum of floor(n/p^i) mod 2 over i >= 1,
+*   so that
+*
+*       n! = ((n/2)!)^2 * swing(n)
+*
+*   needs one squaring and one product of primes per halving of n. The
+*   factors of two are left out of every swing and restored with a single
+*   shift: n! holds exactly n - popcount(n) of them.
+*
+*   Binomial coefficients use the same prime factorization. The exponent of p
+*   in C(n, k) is the sum of floor(n/p^i) - floor(k/p^i) - floor((n-k)/p^i)
+*   (Legendre's formula). The primorial is the product of the primes.
+*/
+#include "Alginate.hpp"
+#include <vector>
+
+// Returns every prime up to n (sieve of Eratosthenes).
+static std::vector<uint32_t> primes_up_to(uint32_t n)
+{
+    std::vector<uint32_t> primes;
+    std::vector<bool> composite((size_t) n + 1, false);
+    for (uint64_t i = 2; i <= n; i++)
+    {
+        if (composite[i])
+            continue;
+        primes.push_back((uint32_t) i);
+        for (uint64_t j = i*i; j <= n; j += i)
+            composite[j] = true;
+    }
+
+    return primes;
+}
+
+// Multiplies p^e into the packed factors, where acc collects native factors until it would overflow.
+static void pack_factor(std::vector<AlgInt>& values, uint64_t& acc, uint64_t p, uint32_t e)
+{
+    for (uint32_t i = 0; i < e; i++)
+    {
+        if (acc > UINT64_MAX / p)
+        {
+            values.push_back(AlgInt(acc));
+            acc = 1;
+        }
+        acc *= p;
+    }
+
+    return;
+}
+
+// ret = the product of every value (which are consumed), with a balanced product tree.
+static void product_tree(std::vector<AlgInt>& values, uint64_t acc, AlgInt& ret)
+{
+    values.push_back(AlgInt(acc));
+
+    //* Every level multiplies neighbours, and an odd value out is carried up alone.
+    while (values.size() > 1)
+    {
+        size_t half = values.size() / 2;
+        for (size_t i = 0; i < half; i++)
+            AlgInt::mul(values[2*i], values[2*i + 1], values[i]);
+        if (values.size() & 1)
+            std::swap(values[half], values.back());
+
+        values.resize((values.size() + 1) / 2);
+    }
+
+    // Return values
+    std::swap(values[0], ret);
+    return;
+}
+
+// ret = the odd part of n!, where primes holds every prime up to n.
+static void odd_factorial(uint32_t n, const std::vector<uint32_t>& primes, AlgInt& ret)
+{
+    //* Small factorials are computed natively (20! < 2^64).
+    if (n <= 20)
+    {
+        uint64_t fact = 1;
+        for (uint64_t i = 2; i <= n; i++)
+            fact *= i;
+        ret = fact >> __builtin_ctzll(fact);
+        return;
+    }
+
+    //? odd(n!) = odd((n/2)!)^2 * odd(swing(n))
+    odd_factorial(n / 2, primes, ret);
+    AlgInt::mul(ret, ret, ret);
+
+    std::vector<AlgInt> values;
+    uint64_t acc = 1;
+    for (size_t i = 1; i < primes.size() && primes[i] <= n; i++)
+    {
+        //* e = sum of floor(n/p^i) mod 2, which is 1 for every p > n/2.
+        uint32_t p = primes[i], e = 0;
+        for (uint32_t q = n / p; q; q /= p)
+            e += q & 1;
+        pack_factor(values, acc, p, e);
+    }
+
+    AlgInt swing;
+    product_tree(values, acc, swing);
+    AlgInt::mul(ret, swing, ret);
+
+    return;
+}
+
+void AlgInt::factorial(uint32_t n, AlgInt& ret)
+{
+    std::vector<uint32_t> primes = primes_up_to(n);
+
+    //* n! = odd(n!) * 2^(n - popcount(n))
+    AlgInt tret;
+    odd_factorial(n, primes, tret);
+    bw_shl(tret, n - __builtin_popcount(n), tret);
+
+    // Return values
+    swap(tret, ret);
+    return;
+}
+
+void AlgInt::binomial(uint32_t n, uint32_t k, AlgInt& ret)
+{
+    if (k > n)
+        return (void) (ret = 0);
+
+    std::vector<uint32_t> primes = primes_up_to(n);
+    std::vector<AlgInt> values;
+    uint64_t acc = 1;
+    for (uint32_t p : primes)
+    {
+        //* Legendre's formula for n! / (k! * (n-k)!)
+        uint32_t e = 0;
+        for (uint64_t pow = p; pow <= n; pow *= p)
+            e += n/pow - k/pow - (n-k)/pow;
+        pack_factor(values, acc, p, e);
+    }
+
+    AlgInt tret;
+    product_tree(values, acc, tret);
+
+    // Return values
+    swap(tret, ret);
+    return;
+}
+
+void AlgInt::primorial(uint32_t n, AlgInt& ret)
+{
+    std::vector<uint32_t> primes = primes_up_to(n);
+    std::vector<AlgInt> values;
+    uint64_t acc = 1;
+    for (uint32_t p : primes)
+        pack_factor(values, acc, p, 1);
+
+    AlgInt tret;
+    product_tree(values, acc, tret);
+
+    // Return values
+    swap(tret, ret);
+    return;
+}
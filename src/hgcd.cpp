@@ -0,0 +1,230 @@
+/**
+*   File: hgcd.cpp
+*   Project: Alginate
+*   SPDX-License-Identifier: Unlicense
+*
+*   Lehmer's algorithm only removes about 30 bits per pass over the digits, so
+*   the gcd of huge operands is still quadratic. The half-gcd (HGCD) is a
+*   divide and conquer version of the same idea: the quotients of the first
+*   half of Euclid's algorithm only depend on the leading half of the bits.
+*
+*   hgcd(a, b) performs Euclid steps until b has about half the bits of a, and
+*   returns the product of the steps as a 2x2 matrix M, where (a, b) equals
+*   M * (a', b'). For large operands, the steps are found recursively:
+*
+*       1. hgcd() of the leading n/2 bits of a and b removes about n/4 bits.
+*          Its matrix is applied to the full a and b with fast multiplication.
+*       2. hgcd() of the leading bits of the new a and b, chosen so that the
+*          remaining n/4 bits are removed, is applied the same way.
+*       3. Lehmer steps (or divisions) finish any remaining bits.
+*
+*   Each level multiplies numbers of its own size, so the total cost is
+*   O(M(n) log n), where M(n) is the cost of a multiplication (Karatsuba).
+*
+*   The matrix of a leading part is almost always correct for the full
+*   operands, but its final step or two might not be. Every entry of M is
+*   non-negative and det(M) = +-1, so applying M^-1 can never change the gcd.
+*   A matrix is only accepted if the result is a proper Euclid pair
+*   (a' > b' >= 0). Otherwise it is discarded, and the following steps simply
+*   perform the work again, so correctness never depends on the leading bits.
+*
+*   The extended gcd keeps the accumulated matrix. The cofactors of the small
+*   pair (a', b') that remains are mapped back through M^-1.
+*/
+#include "Alginate.hpp"
+#include <cstdlib>
+
+// Operands of at most this many digits are reduced with Lehmer steps instead of recursion.
+constexpr size_t HGCD_BASE_DIGITS = 256;
+
+// A single Euclid step (a, b) = (b, a - q*b).
+static void euclid_step(AlgInt& a, AlgInt& b, AlgInt& q)
+{
+    AlgInt r;
+    AlgInt::div(a, b, q, r);
+    std::swap(a, b);
+    std::swap(b, r);
+
+    return;
+}
+
+void AlgInt::HalfGcdMatrix::mul_step(const AlgInt& q)
+{
+    //* [[m00, m01], [m10, m11]] * [[q, 1], [1, 0]] = [[m00*q + m01, m00], [m10*q + m11, m10]]
+    AlgInt temp;
+    AlgInt::mul(m00, q, temp);
+    AlgInt::add(temp, m01, temp);
+    AlgInt::swap(m00, m01);
+    AlgInt::swap(m00, temp);
+
+    AlgInt::mul(m10, q, temp);
+    AlgInt::add(temp, m11, temp);
+    AlgInt::swap(m10, m11);
+    AlgInt::swap(m10, temp);
+
+    det = -det;
+    return;
+}
+
+void AlgInt::HalfGcdMatrix::mul_lehmer(const CofactorMatrix& step)
+{
+    //* L^-1 = det(L) * [[d, -b], [-c, a]] has the absolute values of L's entries,
+    //*  since the signs of Euclid's cofactors alternate. Each row of M * L^-1 is
+    //*  a non-negative combination of the row, computed in a single pass.
+    CofactorMatrix row = {std::abs(step.d), std::abs(step.c), std::abs(step.b), std::abs(step.a)};
+    AlgInt::apply_matrix(m00, m01, row);
+    AlgInt::apply_matrix(m10, m11, row);
+
+    // Every step has a determinant of -1, and an odd number of steps leaves b positive.
+    if (step.b > 0)
+        det = -det;
+    return;
+}
+
+void AlgInt::HalfGcdMatrix::mul(const HalfGcdMatrix& other)
+{
+    AlgInt t0, t1, r00, r01, r10, r11;
+
+    AlgInt::mul(m00, other.m00, t0);
+    AlgInt::mul(m01, other.m10, t1);
+    AlgInt::add(t0, t1, r00);
+    AlgInt::mul(m00, other.m01, t0);
+    AlgInt::mul(m01, other.m11, t1);
+    AlgInt::add(t0, t1, r01);
+    AlgInt::mul(m10, other.m00, t0);
+    AlgInt::mul(m11, other.m10, t1);
+    AlgInt::add(t0, t1, r10);
+    AlgInt::mul(m10, other.m01, t0);
+    AlgInt::mul(m11, other.m11, t1);
+    AlgInt::add(t0, t1, r11);
+
+    // Return values
+    AlgInt::swap(r00, m00);
+    AlgInt::swap(r01, m01);
+    AlgInt::swap(r10, m10);
+    AlgInt::swap(r11, m11);
+    det *= other.det;
+    return;
+}
+
+bool AlgInt::HalfGcdMatrix::apply_inverse(AlgInt& a, AlgInt& b) const
+{
+    //* M^-1 = det * [[m11, -m01], [-m10, m00]]
+    AlgInt t0, t1, ta, tb;
+    AlgInt::mul(m11, a, t0);
+    AlgInt::mul(m01, b, t1);
+    AlgInt::sub(t0, t1, ta);
+    AlgInt::mul(m00, b, t0);
+    AlgInt::mul(m10, a, t1);
+    AlgInt::sub(t0, t1, tb);
+    if (det < 0)
+    {
+        ta.sign = !ta.sign && ta.size;
+        tb.sign = !tb.sign && tb.size;
+    }
+
+    //! A matrix from the leading bits may be wrong in its final steps.
+    if (ta.sign || tb.sign || AlgInt::cmp(ta, tb) <= 0)
+        return false;
+
+    // Return values
+    AlgInt::swap(ta, a);
+    AlgInt::swap(tb, b);
+    return true;
+}
+
+void AlgInt::hgcd(AlgInt& a, AlgInt& b, HalfGcdMatrix* mat)
+{
+    if (mat)
+        *mat = HalfGcdMatrix();
+
+    // Steps are performed until b has at most s bits.
+    size_t n = a.get_bitsize();
+    size_t s = n/2 + 1;
+    if (b.get_bitsize() <= s)
+        return;
+
+    //? Recursive steps for large operands
+    AlgInt q;
+    if (a.size > HGCD_BASE_DIGITS)
+    {
+        AlgInt lead_a, lead_b;
+        HalfGcdMatrix lead;
+
+        //* The leading n/2 bits remove about n/4 bits.
+        bw_shr(a, n/2, lead_a);
+        bw_shr(b, n/2, lead_b);
+        hgcd(lead_a, lead_b, &lead);
+        if (lead.apply_inverse(a, b) && mat)
+            mat->mul(lead);
+
+        //* A single step balances the leading bits of the second call.
+        if (b.get_bitsize() > s)
+        {
+            euclid_step(a, b, q);
+            if (mat)
+                mat->mul_step(q);
+        }
+
+        //* The leading 2(n' - s) bits remove the remaining n' - s bits.
+        size_t n2 = a.get_bitsize();
+        if (b.get_bitsize() > s && n2 > s)
+        {
+            size_t shift = (2*s > n2) ? 2*s - n2 : 0;
+            bw_shr(a, shift, lead_a);
+            bw_shr(b, shift, lead_b);
+            hgcd(lead_a, lead_b, &lead);
+            if (lead.apply_inverse(a, b) && mat)
+                mat->mul(lead);
+        }
+    }
+
+    //? Remaining steps (all steps for small operands)
+    CofactorMatrix step;
+    while (b.get_bitsize() > s)
+    {
+        //* Lehmer steps never drop b below s bits, the final step is a division.
+        if (lehmer_matrix(a, b, step, s))
+        {
+            apply_matrix(a, b, step);
+            if (mat)
+                mat->mul_lehmer(step);
+        }
+        else
+        {
+            euclid_step(a, b, q);
+            if (mat)
+                mat->mul_step(q);
+        }
+    }
+
+    return;
+}
+
+void AlgInt::hgcd_reduce(AlgInt& a, AlgInt& b, size_t digits, HalfGcdMatrix* mat)
+{
+    if (mat)
+        *mat = HalfGcdMatrix();
+
+    //? Primary reduction loop (each hgcd() halves the bitsize of b)
+    HalfGcdMatrix step;
+    AlgInt q;
+    while (b.size > digits)
+    {
+        //* hgcd() only reduces b relative to a, so an unbalanced pair needs a division first.
+        if (b.get_bitsize() <= a.get_bitsize()/2 + 1)
+        {
+            euclid_step(a, b, q);
+            if (mat)
+                mat->mul_step(q);
+            continue;
+        }
+
+        //* The steps are only tracked if the caller needs them.
+        hgcd(a, b, (mat) ? &step : nullptr);
+        if (mat)
+            mat->mul(step);
+    }
+
+    return;
+}
@@ -0,0 +1,173 @@
+/**
+*   File: inv_mod_pow2.cpp
+*   Project: Alginate
+*   SPDX-License-Identifier: Unlicense
+*
+*   The inverse of an odd m modulo a power of two does not need Euclid's
+*   algorithm at all. Newton's iteration for 1/m, x' = x * (2 - m*x), doubles
+*   the number of correct low bits every step (Hensel lifting):
+*
+*       if m*x == 1 (mod 2^j), then m*x' == 1 (mod 2^2j)
+*
+*   Every odd m is its own inverse modulo 8 (m*m == 1 (mod 8)), so five native
+*   steps starting from x = m give the inverse of the low 64 bits in O(1).
+*   Larger inverses continue from those 64 bits, and double their number of
+*   digits with every step. Writing the step as x' = x - x*e, where
+*   e = m*x - 1 is divisible by 2^j, only the upper half of x' changes, and
+*   only the upper half of e is ever multiplied. The final step dominates the
+*   cost, so the full inverse costs a small constant number of multiplications
+*   (O(M(n)), where M(n) is the cost of a multiplication).
+*
+*   Montgomery setup needs -m^-1 (mod R) for R = 2^r_shift, which is exactly
+*   this inverse. Exact division (Jebelean) is the other user: if y divides x,
+*   then q = x / y is the only value below 2^k with q == x * y^-1 (mod 2^k),
+*   where k is the bitsize of q. A single multiplication with the inverse
+*   replaces the long division, whose cost grows with the product of the
+*   sizes.
+*/
+#include "Alginate.hpp"
+
+// Divisors of at most this many digits (or quotients of less than half) use long division in div_exact().
+constexpr size_t EXACT_DIV_DIGITS = 24;
+
+uint64_t AlgInt::inv_u64(uint64_t m)
+{
+    //* m*m == 1 (mod 8), and each step doubles the correct bits (3, 6, 12, 24, 48, 96).
+    uint64_t x = m;
+    for (size_t i = 0; i < 5; i++)
+        x *= 2 - m*x;
+
+    return x;
+}
+
+void AlgInt::inv_mod_pow2(const AlgInt& m, size_t k, AlgInt& ret)
+{
+    //? Exception block
+    if (m.size == 0 || (m.num[0] & 1) == 0)
+        throw std::domain_error("Even m (m % 2 == 0) not supported.");
+
+    // ret = x (mod 2^(32*digits)), or a copy of x if it has fewer digits.
+    auto low_digits = [](const AlgInt& x, size_t digits, AlgInt& ret)
+    {
+        digits = (x.size < digits) ? x.size : digits;
+        ret.resize(digits);
+        for (size_t i = 0; i < digits; i++)
+            ret.num[i] = x.num[i];
+        ret.sign = false;
+        ret.trunc();
+    };
+
+    //? Inverse of the low 64 bits
+    uint64_t m_low = m.num[0];
+    if (m.size > 1)
+        m_low |= (uint64_t) m.num[1] << 32;
+
+    AlgInt inv = inv_u64(m_low);
+    size_t digits = (k + 31) / 32;
+
+    //? Newton steps, doubling the digits of inv (which are correct to p digits).
+    AlgInt m_q, e, w;
+    for (size_t p = 2; p < digits; )
+    {
+        size_t q = (2*p < digits) ? 2*p : digits;
+
+        //* e = m*inv - 1 (mod 2^(32q)), which is divisible by 2^(32p).
+        low_digits(m, q, m_q);
+        mul(m_q, inv, e);
+        low_digits(e, q, e);
+        sub(e, 1, e);
+
+        //* The upper q - p digits of inv' = inv - inv*(e / 2^(32p)) (mod 2^(32q)).
+        if (e.size > p)
+        {
+            bw_shr(e, 32*p, e);
+            mul(inv, e, w);
+            low_digits(w, q - p, w);
+        }
+        else
+            w = 0;
+
+        inv.resize(q);
+        bool borrow = false;
+        for (size_t i = p; i < q; i++)
+        {
+            //* 0 - w, in two's complement over the upper digits.
+            uint32_t w_i = (i - p < w.size) ? w.num[i - p] : 0;
+            inv.num[i] = (uint32_t) (0 - (uint64_t) w_i - borrow);
+            borrow = w_i || borrow;
+        }
+        inv.trunc();
+
+        p = q;
+    }
+
+    //? Exactly k bits
+    low_digits(inv, digits, inv);
+    if ((k & 0x1F) && inv.size == digits)
+    {
+        inv.num[digits-1] &= (1u << (k & 0x1F)) - 1;
+        inv.trunc();
+    }
+
+    //* (-m)^-1 == -(m^-1) (mod 2^k)
+    if (m.sign && inv.size)
+    {
+        AlgInt pow2 = 1;
+        bw_shl(pow2, k, pow2);
+        sub(pow2, inv, inv);
+    }
+
+    // Return values
+    swap(inv, ret);
+    return;
+}
+
+void AlgInt::div_exact(const AlgInt& x, const AlgInt& y, AlgInt& q)
+{
+    //? Exception block
+    if (y.size == 0)
+        throw std::domain_error("Divide by Zero.");
+
+    bool sign = x.sign != y.sign;
+
+    //* A multiple of y is either zero or at least as large as y.
+    if (x.get_bitsize() < y.get_bitsize())
+        return (void) (q = 0);
+
+    //* Trailing zero bits are shared by x and y, and leave an odd divisor.
+    size_t shift = 0;
+    while (y.num[shift >> 5] == 0)
+        shift += 32;
+    shift += __builtin_ctz(y.num[shift >> 5]);
+
+    AlgInt x_odd, y_odd;
+    bw_shr(x, shift, x_odd);
+    bw_shr(y, shift, y_odd);
+    x_odd.sign = false;
+    y_odd.sign = false;
+
+    //? Long division is faster for small divisors or quotients.
+    size_t x_bits = x_odd.get_bitsize();
+    size_t y_bits = y_odd.get_bitsize();
+    AlgInt tq;
+    if (y_odd.size <= EXACT_DIV_DIGITS || x_odd.size - y_odd.size < EXACT_DIV_DIGITS/2)
+        div(x_odd, y_odd, tq);
+    else
+    {
+        //* q == x * y^-1 (mod 2^k), where q has at most k bits.
+        size_t k = x_bits - y_bits + 1;
+        AlgInt inv, mask = 1;
+        inv_mod_pow2(y_odd, k, inv);
+        bw_shl(mask, k, mask);
+        sub(mask, 1, mask);
+
+        bw_and(x_odd, mask, x_odd);
+        mul(x_odd, inv, tq);
+        bw_and(tq, mask, tq);
+    }
+
+    // Return values
+    tq.sign = sign && tq.size;
+    swap(tq, q);
+    return;
+}
@@ -0,0 +1,188 @@
+/**
+*   File: jacobi.cpp
+*   Project: Alginate
+*   SPDX-License-Identifier: Unlicense
+*
+*   The Jacobi symbol (a/n) for an odd n > 0 is computed with the rules
+*
+*       (a/n) == (a mod n / n)
+*       (2/n) == -1 if n == 3, 5 (mod 8), and 1 otherwise
+*       (a/n) == (n/a), negated if both a and n == 3 (mod 4)   (a, n odd)
+*
+*   For operands below 2^64, the binary algorithm removes the factors of two
+*   with a single count of trailing zeros, and replaces the reduction by a
+*   subtraction of the two odd values.
+*
+*   Larger operands follow Euclid's algorithm instead, so that Lehmer steps
+*   (see lehmer.cpp) can remove about 30 bits at a time. Euclid's remainders
+*   are not always odd, so the state tracks which of the pair (big, sml) is
+*   the (odd) denominator, and whether the symbol is negated. A step
+*   r = big - q*sml updates it as follows:
+*
+*     - If the denominator is big and sml is odd, reciprocity first moves the
+*       denominator to sml.
+*     - (big/sml) == (r/sml), because r == big (mod sml).
+*     - (sml/big) with an even sml becomes (sml/r), which is odd. Since
+*       r == big (mod sml), the two symbols can only differ by a sign that
+*       depends on sml, big and r modulo 8: they are equal if 4 divides sml,
+*       and otherwise differ by (2/big) * (2/r) * (-1)^((c-1)/2 * ((big-1)/2 + (r-1)/2)),
+*       where sml = 2c.
+*
+*   Every rule only needs the low 3 bits of the pair, and r (mod 8) only needs
+*   the low 3 bits of the quotient. The quotients of a Lehmer simulation are
+*   recorded, which updates the state without ever computing the remainders in
+*   between.
+*
+*   Even and negative n are supported as the Kronecker symbol:
+*   (a/2) == (2/a) for an odd a, (a/-1) == -1 for a negative a, and (a/0) == 1
+*   only for a == 1 or a == -1.
+*/
+#include "Alginate.hpp"
+#include <vector>
+
+// (2/n) == -1 if n == 3, 5 (mod 8)
+static bool two_negates(uint64_t n)
+{
+    return (n & 7) == 3 || (n & 7) == 5;
+}
+
+// Jacobi symbol (a/n) for an odd n, with the binary algorithm.
+static int jacobi_u64(uint64_t a, uint64_t n)
+{
+    int result = 1;
+    a %= n;
+
+    while (a)
+    {
+        //* All factors of two at once.
+        int zeros = __builtin_ctzll(a);
+        a >>= zeros;
+        if ((zeros & 1) && two_negates(n))
+            result = -result;
+
+        //* Quadratic reciprocity: (a/n) == -(n/a) if both a and n == 3 (mod 4)
+        if (a < n)
+        {
+            std::swap(a, n);
+            if ((a & 3) == 3 && (n & 3) == 3)
+                result = -result;
+        }
+
+        // Both are odd, so a - n is even.
+        a -= n;
+    }
+
+    return (n == 1) ? result : 0;
+}
+
+// The symbol of a Euclid pair (big, sml), which only needs their low 3 bits.
+struct JacobiState
+{
+    unsigned big;       // big (mod 8)
+    unsigned sml;       // sml (mod 8)
+    bool den_sml;       // The symbol is (big/sml) if true, and (sml/big) otherwise.
+    bool neg;           // The symbol is negated.
+};
+
+// Updates the state for the Euclid step (big, sml) = (sml, big - q*sml), from the low 3 bits of q.
+static void jacobi_step(JacobiState& state, unsigned q)
+{
+    //* Reciprocity moves an odd denominator to sml, if sml is odd.
+    if (!state.den_sml && (state.sml & 1))
+    {
+        state.neg ^= (state.big & 3) == 3 && (state.sml & 3) == 3;
+        state.den_sml = true;
+    }
+
+    unsigned r = (state.big + 64 - (q & 7) * state.sml) & 7;
+    if (state.den_sml)
+    {
+        //* (big/sml) == (r/sml), where sml becomes big.
+        state.den_sml = false;
+    }
+    else if ((state.sml & 3) == 2)
+    {
+        //* (sml/big) == (sml/r), up to the sign from (2/big), (2/r) and c = sml/2.
+        unsigned c = state.sml >> 1;
+        state.neg ^= two_negates(state.big) != two_negates(r);
+        state.neg ^= (c & 3) == 3 && ((state.big & 3) == 3) != ((r & 3) == 3);
+        state.den_sml = true;
+    }
+    else
+    {
+        //* 4 divides sml, so (sml/big) == (sml/r).
+        state.den_sml = true;
+    }
+
+    state.big = state.sml;
+    state.sml = r;
+    return;
+}
+
+int AlgInt::jacobi(const AlgInt& a, const AlgInt& n)
+{
+    //? Kronecker extension to zero, negative and even n
+    if (n.size == 0)
+        return (a.size == 1 && a.num[0] == 1) ? 1 : 0;
+
+    //* (a/-1) == -1 for a negative a
+    int result = (n.sign && a.sign) ? -1 : 1;
+
+    size_t zeros = 0;
+    while (n.num[zeros >> 5] == 0)
+        zeros += 32;
+    zeros += __builtin_ctz(n.num[zeros >> 5]);
+
+    //* (a/2) == 0 for an even a, and (2/a) otherwise.
+    if (zeros)
+    {
+        if (a.size == 0 || (a.num[0] & 1) == 0)
+            return 0;
+        if ((zeros & 1) && two_negates(a.num[0]))
+            result = -result;
+    }
+
+    //? (big, sml) = (|n| without factors of two, a mod big)
+    AlgInt big, sml;
+    bw_shr(n, zeros, big);
+    big.sign = false;
+    mod(a, big, sml);
+    if (sml.sign)
+        add(sml, big, sml);
+
+    //? Primary Lehmer loop, starting from (sml/big)
+    JacobiState state = {big.num[0] & 7u, (sml.size) ? sml.num[0] & 7u : 0, false, false};
+    std::vector<uint8_t> quotients;
+    CofactorMatrix step;
+    AlgInt q, r;
+    while (big.size > 2 && sml.size)
+    {
+        quotients.clear();
+        if (lehmer_matrix(big, sml, step, 0, &quotients))
+        {
+            for (uint8_t q_low : quotients)
+                jacobi_step(state, q_low);
+            apply_matrix(big, sml, step);
+        }
+        else
+        {
+            //* A single Euclid step, where the buffers rotate instead of being copied.
+            div(big, sml, q, r);
+            jacobi_step(state, (q.size) ? q.num[0] : 0);
+            swap(big, sml);
+            swap(sml, r);
+        }
+    }
+
+    if (state.neg)
+        result = -result;
+
+    //* A zero sml ends Euclid's algorithm early, with the odd gcd big as the denominator.
+    if (sml.size == 0)
+        return (cmp(big, 1) == 0) ? result : 0;
+
+    //? The binary algorithm finishes both below 2^64.
+    uint64_t big_u64 = big.output_uint64();
+    uint64_t sml_u64 = sml.output_uint64();
+    return result * ((state.den_sml) ? jacobi_u64(big_u64, sml_u64) : jacobi_u64(sml_u64, big_u64));
+}
@@ -0,0 +1,115 @@
+/**
+*   File: lehmer.cpp
+*   Project: Alginate
+*   SPDX-License-Identifier: Unlicense
+*
+*   Lehmer's algorithm speeds up Euclid's algorithm by noticing that the
+*   quotients of the first several steps only depend on the leading bits of
+*   the operands. Euclid's algorithm is simulated on the leading 62 bits of
+*   big and sml (both shifted by the same amount) with native integers, while
+*   the steps are accumulated in a 2x2 cofactor matrix:
+*
+*       big' = a*big + b*sml
+*       sml' = c*big + d*sml
+*
+*   The leading bits are only an approximation, so every simulated quotient
+*   is checked against both bounds of the true ratio (Knuth's Algorithm L): the
+*   quotient is only accepted while (x + a) / (y + c) == (x + b) / (y + d).
+*   Each simulation typically accepts around 30 bits of quotients (about 18
+*   Euclid steps), which are then applied to the full operands with a single
+*   pass over their digits. If not even a single step could be simulated (a
+*   huge quotient), the caller falls back to a single full division.
+*
+*   The cofactor matrix is shared by every algorithm that is based on Euclid
+*   (gcd, and the variants of the extended gcd). The Jacobi symbol also needs
+*   the low bits of every quotient, which the simulation can record.
+*/
+#include "Alginate.hpp"
+#include <algorithm>
+
+__extension__ typedef __int128 int128_t;
+__extension__ typedef unsigned __int128 uint128_t;
+
+// Bits of the leading part. Leaves headroom for x + a and y + c in a signed 64-bit integer.
+constexpr size_t LEHMER_BITS = 62;
+
+bool AlgInt::lehmer_matrix(const AlgInt& big, const AlgInt& sml, CofactorMatrix& mat, size_t min_bits, std::vector<uint8_t>* quotients)
+{
+    //? Leading 62 bits of big, and the same bits of sml.
+    size_t bitsize = big.get_bitsize();
+    size_t shift = (bitsize > LEHMER_BITS) ? bitsize - LEHMER_BITS : 0;
+    size_t dig_shift = shift >> 5;
+
+    uint128_t lead_big = 0, lead_sml = 0;
+    for (size_t i = 0; i < 3; i++)
+    {
+        if (dig_shift + i < big.size)
+            lead_big |= (uint128_t) big.num[dig_shift + i] << (32*i);
+        if (dig_shift + i < sml.size)
+            lead_sml |= (uint128_t) sml.num[dig_shift + i] << (32*i);
+    }
+    int64_t x = (int64_t) (lead_big >> (shift & 0x1F));
+    int64_t y = (int64_t) (lead_sml >> (shift & 0x1F));
+
+    //? Primary simulation loop (Knuth's Algorithm L)
+    int64_t a = 1, b = 0, c = 0, d = 1, temp;
+    while (y + c > 0 && y + d > 0)
+    {
+        //* The quotient is only known if both bounds of big/sml agree.
+        int64_t q = (x + a) / (y + c);
+        if (q != (x + b) / (y + d))
+            break;
+
+        //* The next remainder must keep at least min_bits bits (at full scale).
+        temp = x - q*y;
+        if (min_bits && ((temp) ? 64 - __builtin_clzll(temp) : 0) + shift <= min_bits)
+            break;
+
+        if (quotients)
+            quotients->push_back((uint8_t) q);
+
+        temp = a - q*c;
+        a = c;
+        c = temp;
+
+        temp = b - q*d;
+        b = d;
+        d = temp;
+
+        temp = x - q*y;
+        x = y;
+        y = temp;
+    }
+
+    // Return values
+    mat = {a, b, c, d};
+    return b != 0;
+}
+
+void AlgInt::apply_matrix(AlgInt& big, AlgInt& sml, const CofactorMatrix& mat)
+{
+    //* Both results are non-negative, so they are computed in place with a
+    //*  signed carry per result. Two extra digits hold the growth of cofactors.
+    size_t size = std::max(big.size, sml.size) + 2;
+    big.resize(size);
+    sml.resize(size);
+
+    int128_t carry_big = 0, carry_sml = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+        uint32_t big_i = big.num[i];
+        uint32_t sml_i = sml.num[i];
+
+        carry_big += (int128_t) mat.a * big_i + (int128_t) mat.b * sml_i;
+        carry_sml += (int128_t) mat.c * big_i + (int128_t) mat.d * sml_i;
+
+        big.num[i] = (uint32_t) carry_big;
+        sml.num[i] = (uint32_t) carry_sml;
+        carry_big >>= 32;
+        carry_sml >>= 32;
+    }
+
+    big.trunc();
+    sml.trunc();
+    return;
+}
@@ -27,42 +27,64 @@
 *   perform many of them without decreasing performance. Although the code here
 *   does not implement any trial divisions, prime generation function are encouraged
 *   to increase performance when generating primes of about 2048-4096 bits with this library.
+*
+*   Everything except the witness itself depends only on the candidate: s, d,
+*   candidate-1 and the Montgomery setup of the candidate. MillerRabinContext
+*   computes these once, so testing many witnesses against the same candidate
+*   only costs the exponentiations. The witness is converted into Montgomery
+*   space once, and both witness**d and every following squaring stay there.
+*   The comparisons against 1 and -1 are made against their Montgomery forms
+*   (R and -R mod candidate), so nothing is ever converted back.
+*
+*   The rounds for different witnesses are independent exponentiations with the
+*   same modulus, so they may be evaluated concurrently. A pool of workers takes
+*   witnesses from a shared atomic index. A failed witness proves the candidate
+*   composite, so it raises an atomic flag that stops every worker from taking
+*   another witness.
 */
 #include "Alginate.hpp"
+#include <atomic>
+#include <thread>
 
-bool AlgInt::miller_rabin(const AlgInt& candidate, const AlgInt& witness)
+MillerRabinContext::MillerRabinContext(const AlgInt& candidate) : ctx(candidate)
 {
-    // If candidate == 0 or candidate is even, candidate is not prime.
-    if (candidate.size == 0 || (candidate.num[0] & 1) == 0)
-        return false;
+    // Exception block (even candidates are rejected by ctx)
+    if (AlgInt::cmp(candidate, 3) < 0)
+        throw std::domain_error("Candidate must be at least 3.");
 
     // No borrow/overflow checks are required because candidate must be odd.
-    AlgInt cand_sub1 = candidate;
-    cand_sub1.num[0]--;
+    AlgInt::sub(candidate, 1, cand_sub1);
 
-    // Exception block
-    if (cmp(witness, 2) == -1 || cmp(witness, cand_sub1) >= 0)
-        throw std::domain_error("Witness must be within the range [2, candidate-1)");
-
-    // s is at least 1, because cand_minus_1 is always even
+    // s is at least 1, because cand_sub1 is always even
     //* candidate = d<<s + 1
-    size_t s = 1;
-    AlgInt d, temp;
-
-    // while (d >> s) is even, s++ 
+    s = 1;
     while (cand_sub1.get_bit(s) == 0)
         s++;
-    bw_shr(cand_sub1, s, d);
+    AlgInt::bw_shr(cand_sub1, s, d);
+
+    //* -1 in Montgomery space is candidate - R (mod candidate)
+    AlgInt::sub(candidate, ctx.one(), minus_one);
+
+    return;
+}
+
+bool MillerRabinContext::test(const AlgInt& witness) const
+{
+    // Exception block
+    if (AlgInt::cmp(witness, 2) == -1 || AlgInt::cmp(witness, cand_sub1) >= 0)
+        throw std::domain_error("Witness must be within the range [2, candidate-1)");
 
     // Check witness^d == 1 (mod candidate)
     //* Because this is a full exponentiation, this is expensive.
-    mont_exp(witness, d, candidate, temp);
-    if (cmp(temp, 1) == 0)
-        return true;  
+    AlgInt temp;
+    ctx.to_mont(witness, temp);
+    ctx.exp(temp, d, temp);
+    ctx.reduce(temp);
+    if (AlgInt::cmp(temp, ctx.one()) == 0)
+        return true;
 
     // Check witness^d == -1 (mod candidate)
-    //* temp == candidate - 1 (-1 mod n == n-1)
-    if (cmp(temp, cand_sub1) == 0)
+    if (AlgInt::cmp(temp, minus_one) == 0)
         return true;
 
     // Check each possible r (r in range of [0, s), and we checked 0 previously)
@@ -72,14 +94,70 @@ bool AlgInt::miller_rabin(const AlgInt& candidate, const AlgInt& witness)
         //* This simplifies to a squaring every loop, which is much faster.
         //! This squaring loop technique was directly stolen from GMP.
         //! My own solutions were too slow to function, so credit goes to GMP.
-        mul(temp, temp, temp);
-        mod(temp, candidate, temp);
+        ctx.mul(temp, temp, temp);
+        ctx.reduce(temp);
 
-        //* temp == candidate - 1 (-1 mod n == n-1)
-        if (cmp(temp, cand_sub1) == 0)
+        if (AlgInt::cmp(temp, minus_one) == 0)
             return true;
-    }   
+    }
 
     //* If all checks fail, then the number is guaranteed not prime.
     return false;
-}
\ No newline at end of file
+}
+
+bool MillerRabinContext::test_parallel(const std::vector<AlgInt>& witnesses, size_t thread_count) const
+{
+    //? Exception block
+    //* The workers must never throw, so every witness is checked up front.
+    for (const AlgInt& witness : witnesses)
+    {
+        if (AlgInt::cmp(witness, 2) == -1 || AlgInt::cmp(witness, cand_sub1) >= 0)
+            throw std::domain_error("Witness must be within the range [2, candidate-1)");
+    }
+    if (thread_count == 0)
+        thread_count = 1;
+    if (thread_count > witnesses.size())
+        thread_count = witnesses.size();
+
+    std::atomic<size_t> next(0);
+    std::atomic<bool> composite(false);
+
+    auto worker = [&]()
+    {
+        // Take witnesses until they run out, or any worker proves the candidate composite.
+        for (size_t i = next++; i < witnesses.size() && !composite.load(std::memory_order_relaxed); i = next++)
+        {
+            if (!test(witnesses[i]))
+                composite.store(true, std::memory_order_relaxed);
+        }
+    };
+
+    //? Worker pool (the calling thread is one of the workers)
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < thread_count; i++)
+        workers.emplace_back(worker);
+    worker();
+    for (std::thread& thread : workers)
+        thread.join();
+
+    return !composite.load();
+}
+
+const AlgInt& MillerRabinContext::get_candidate() const
+{
+    return ctx.get_mod();
+}
+
+bool AlgInt::miller_rabin(const AlgInt& candidate, const AlgInt& witness)
+{
+    // If candidate == 0 or candidate is even, candidate is not prime.
+    if (candidate.size == 0 || (candidate.num[0] & 1) == 0)
+        return false;
+
+    //* Negative candidates and 1 have no valid witness range.
+    if (cmp(candidate, 3) < 0)
+        throw std::domain_error("Witness must be within the range [2, candidate-1)");
+
+    MillerRabinContext mr(candidate);
+    return mr.test(witness);
+}
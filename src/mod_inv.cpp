@@ -0,0 +1,99 @@
+/**
+*   File: mod_inv.cpp
+*   Project: Alginate
+*   SPDX-License-Identifier: Unlicense
+*
+*   The modular inverse x^-1 (mod m) is the cofactor of x from the Extended
+*   Euclidean Algorithm on (m, x), but the cofactor of m is never needed. Every
+*   remainder r_i of Euclid's algorithm is tracked along with the single
+*   cofactor t_i, where r_i == t_i * x (mod m):
+*
+*       (r_0, t_0) = (m, 0),  (r_1, t_1) = (x, 1)
+*       t_(i+1) = t_(i-1) - q_i * t_i
+*
+*   The signs of t_i alternate, so only their magnitudes are stored, and
+*   every update becomes an addition: |t_(i+1)| = |t_(i-1)| + q_i * |t_i|. A
+*   single flag records the sign of the newest cofactor. Because the
+*   magnitudes are always combined with non-negative coefficients, a Lehmer
+*   cofactor matrix (see lehmer.cpp) is applied to them exactly like it is to
+*   the remainders, with a single pass over the digits. Full division steps
+*   rotate the buffers with swaps instead of copying them.
+*
+*   Huge operands are first reduced with the half-gcd (see hgcd.cpp). Its
+*   matrix M gives the cofactors of the reduced pair directly, as
+*   (a', b') = M^-1 (m, x) == (-det*m01*x, det*m00*x) (mod m).
+*/
+#include "Alginate.hpp"
+#include <cstdlib>
+
+// Operands above this many digits are first reduced with the half-gcd.
+constexpr size_t MOD_INV_HGCD_DIGITS = 8192;
+
+void AlgInt::mod_inv(const AlgInt& x, const AlgInt& m, AlgInt& inv)
+{
+    //? Exception block
+    if (m.sign || m.size == 0)
+        throw std::domain_error("Signed or zero m not supported.");
+
+    // a = m, b = x (mod m)
+    AlgInt a = m, b;
+    mod(x, m, b);
+    if (b.sign)
+        add(b, m, b);
+
+    //* a == -+u0*x and b == +-u1*x (mod m), where neg is the sign of b's cofactor.
+    AlgInt u0 = 0, u1 = 1;
+    bool neg = false;
+
+    //? Huge operands are first halved repeatedly by the half-gcd.
+    if (b.size > MOD_INV_HGCD_DIGITS)
+    {
+        HalfGcdMatrix mat;
+        hgcd_reduce(a, b, MOD_INV_HGCD_DIGITS, &mat);
+
+        AlgInt::swap(u0, mat.m01);
+        AlgInt::swap(u1, mat.m00);
+        neg = mat.det < 0;
+    }
+
+    //? Primary Lehmer loop
+    CofactorMatrix step, cof;
+    AlgInt q, r, temp;
+    while (b.size)
+    {
+        if (lehmer_matrix(a, b, step))
+        {
+            //* The cofactor magnitudes combine with the absolute matrix entries.
+            apply_matrix(a, b, step);
+            cof = {std::abs(step.a), std::abs(step.b), std::abs(step.c), std::abs(step.d)};
+            apply_matrix(u0, u1, cof);
+
+            // An odd number of steps leaves step.b positive.
+            neg ^= (step.b > 0);
+        }
+        else
+        {
+            //* A single Euclid step, where the buffers rotate instead of being copied.
+            div(a, b, q, r);
+            AlgInt::swap(a, b);
+            AlgInt::swap(b, r);
+
+            mul(q, u1, temp);
+            add(u0, temp, u0);
+            AlgInt::swap(u0, u1);
+            neg = !neg;
+        }
+    }
+
+    if (cmp(a, 1) != 0)
+        throw std::domain_error("x^-1 (mod m) does not exist for provided x and m. x^-1 only exists if gcd(x, m) == 1.");
+
+    //* The cofactor of a has the opposite sign of b's. A negative cofactor -u0 is returned as m - u0.
+    mod(u0, m, u0);
+    if (!neg && u0.size)
+        sub(m, u0, u0);
+
+    // Return values
+    AlgInt::swap(u0, inv);
+    return;
+}
@@ -0,0 +1,236 @@
+/**
+*   File: mod_sqrt.cpp
+*   Project: Alginate
+*   SPDX-License-Identifier: Unlicense
+*
+*   A square root of a (mod p) for an odd prime p only exists if the Jacobi
+*   symbol (a/p) == 1 (see jacobi.cpp), which is checked first. The method
+*   depends on the form of p:
+*
+*     - p == 3 (mod 4): r = a^((p+1)/4), a single exponentiation, since
+*       r^2 = a^((p+1)/2) = a * a^((p-1)/2) = a.
+*     - p == 5 (mod 8) (Atkin): with b = (2a)^((p-5)/8) and i = 2a*b^2, where
+*       i^2 == -1, the root is r = a*b*(i - 1). Also a single exponentiation.
+*     - p == 1 (mod 8): Tonelli-Shanks splits p - 1 = q * 2^s. Starting from
+*       x = a^((q+1)/2) and t = a^q (so that x^2 == a*t), every round fixes
+*       the order of t with a power of c = z^q for a non-residue z, until
+*       t == 1. This costs about s^2/2 extra multiplications, which becomes
+*       expensive when p - 1 is divisible by a large power of two.
+*       Cipolla's method instead raises (t + w)^((p+1)/2) in the field
+*       F_p(w), where w^2 = t^2 - a is a non-residue. It costs about twice as
+*       much as an exponentiation, but does not depend on s.
+*
+*   Every path works in Montgomery form (see mont_exp.cpp), on a single
+*   MontgomeryContext for p. The result is verified by squaring it, which
+*   only fails if p was not prime.
+*/
+#include "Alginate.hpp"
+
+// Tonelli-Shanks is used while s^2 <= CIPOLLA_FACTOR * log2(p).
+constexpr size_t CIPOLLA_FACTOR = 12;
+
+// Returns true if the lazily reduced x is 1 in Montgomery form (and reduces x).
+static bool is_one(const MontgomeryContext& ctx, AlgInt& x)
+{
+    ctx.reduce(x);
+    return AlgInt::cmp(x, ctx.one()) == 0;
+}
+
+// Returns the smallest z >= start with (z/p) == -1, or throws if p can not be prime.
+static uint32_t non_residue(const AlgInt& p, uint32_t start)
+{
+    //* Below 2*log2(p)^2, if the generalized Riemann hypothesis holds.
+    size_t bits = p.get_bitsize();
+    for (uint32_t z = start; z < 2*bits*bits + 16; z++)
+    {
+        int jac = AlgInt::jacobi(AlgInt(z), p);
+        if (jac == -1)
+            return z;
+        if (jac == 0 && AlgInt::cmp(p, AlgInt(z)) != 0)
+            break;
+    }
+
+    throw std::domain_error("p is not prime.");
+}
+
+// root = a^(1/2) in Montgomery form, with Tonelli-Shanks (p - 1 = q * 2^s).
+static void tonelli_shanks(const MontgomeryContext& ctx, const AlgInt& a_mont, const AlgInt& p, const AlgInt& q, size_t s, AlgInt& root)
+{
+    //* p == 1 (mod 8) makes 2 a residue, so the search starts at 3.
+    AlgInt z_mont, c, x, t, b, e;
+    ctx.to_mont(AlgInt(non_residue(p, 3)), z_mont);
+    ctx.exp(z_mont, q, c);
+
+    //* x = a^((q+1)/2) and t = a^q, from a single exponentiation w = a^((q-1)/2).
+    AlgInt::bw_shr(q, 1, e);
+    ctx.exp(a_mont, e, b);
+    ctx.mul(a_mont, b, x);
+    ctx.mul(x, b, t);
+
+    //? Primary loop, where the order of t is 2^i for some i < m.
+    size_t m = s;
+    while (!is_one(ctx, t))
+    {
+        // Least i with t^(2^i) == 1
+        size_t i = 0;
+        b = t;
+        do
+        {
+            ctx.mul(b, b, b);
+            if (++i == m)
+                throw std::domain_error("p is not prime.");
+        } while (!is_one(ctx, b));
+
+        // b = c^(2^(m-i-1))
+        b = c;
+        for (size_t j = i + 1; j < m; j++)
+            ctx.mul(b, b, b);
+
+        ctx.mul(x, b, x);
+        ctx.mul(b, b, c);
+        ctx.mul(t, c, t);
+        m = i;
+    }
+
+    // Return values
+    std::swap(x, root);
+    return;
+}
+
+// root = a^(1/2) in Montgomery form, with Cipolla's method in F_p(w).
+static void cipolla(const MontgomeryContext& ctx, const AlgInt& a, const AlgInt& p, AlgInt& root)
+{
+    //* The smallest t where t^2 - a is a non-residue (at most a few tries on average).
+    AlgInt t, w;
+    for (uint32_t i = 1; ; i++)
+    {
+        t = i;
+        AlgInt::mul(t, t, w);
+        AlgInt::sub(w, a, w);
+        AlgInt::mod(w, p, w);
+        if (w.get_sign())
+            AlgInt::add(w, p, w);
+
+        //* t^2 == a is already a root.
+        if (w == 0)
+        {
+            ctx.to_mont(t, root);
+            return;
+        }
+
+        int jac = AlgInt::jacobi(w, p);
+        if (jac == -1)
+            break;
+        if (jac == 0 || i == UINT32_MAX)
+            throw std::domain_error("p is not prime.");
+    }
+
+    AlgInt t_mont, w_mont;
+    ctx.to_mont(t, t_mont);
+    ctx.to_mont(w, w_mont);
+
+    //? (u + v*w) = (t + w)^((p+1)/2), from the most significant bit down.
+    AlgInt e, u = ctx.one(), v = 0, uu, vv, uv;
+    AlgInt::add(p, 1, e);
+    AlgInt::bw_shr(e, 1, e);
+    for (size_t i = e.get_bitsize(); i-- > 0; )
+    {
+        //* (u + v*w)^2 = (u^2 + v^2*w^2) + 2uv*w
+        ctx.mul(u, u, uu);
+        ctx.mul(v, v, vv);
+        ctx.mul(u, v, uv);
+        ctx.mul(vv, w_mont, vv);
+        ctx.add(uu, vv, u);
+        ctx.add(uv, uv, v);
+
+        //* (u + v*w)(t + w) = (u*t + v*w^2) + (u + v*t)*w
+        if (e.get_bit(i))
+        {
+            ctx.mul(u, t_mont, uu);
+            ctx.mul(v, w_mont, vv);
+            ctx.mul(v, t_mont, uv);
+            ctx.add(u, uv, v);
+            ctx.add(uu, vv, u);
+        }
+    }
+
+    // Return values
+    std::swap(u, root);
+    return;
+}
+
+void AlgInt::mod_sqrt(const AlgInt& a, const AlgInt& p, AlgInt& ret)
+{
+    //? Exception block
+    if (p.sign || p.size == 0)
+        throw std::domain_error("Signed or zero p not supported.");
+    if ((p.num[0] & 1) == 0 && cmp(p, 2) != 0)
+        throw std::domain_error("Even p (p % 2 == 0) not supported, except p == 2.");
+
+    AlgInt x;
+    mod(a, p, x);
+    if (x.sign)
+        add(x, p, x);
+
+    // Every value is its own square root (mod 2), and 0 is its own everywhere.
+    if (cmp(p, 2) == 0 || x.size == 0)
+    {
+        swap(x, ret);
+        return;
+    }
+
+    if (jacobi(x, p) != 1)
+        throw std::domain_error("a is not a quadratic residue (mod p).");
+
+    //? Montgomery setup
+    MontgomeryContext ctx(p);
+    AlgInt a_mont, root, e;
+    ctx.to_mont(x, a_mont);
+
+    if ((p.num[0] & 3) == 3)
+    {
+        //? r = a^((p+1)/4)
+        add(p, 1, e);
+        bw_shr(e, 2, e);
+        ctx.exp(a_mont, e, root);
+    }
+    else if ((p.num[0] & 7) == 5)
+    {
+        //? Atkin: b = (2a)^((p-5)/8), i = 2a*b^2, r = a*b*(i - 1)
+        AlgInt a2, b, i;
+        ctx.add(a_mont, a_mont, a2);
+        sub(p, 5, e);
+        bw_shr(e, 3, e);
+        ctx.exp(a2, e, b);
+
+        ctx.mul(b, b, i);
+        ctx.mul(a2, i, i);
+        ctx.sub(i, ctx.one(), i);
+        ctx.mul(a_mont, b, root);
+        ctx.mul(root, i, root);
+    }
+    else
+    {
+        //? p - 1 = q * 2^s
+        size_t s = 3;
+        while (p.get_bit(s) == 0)
+            s++;
+        AlgInt q;
+        bw_shr(p, s, q);
+
+        if (s*s <= CIPOLLA_FACTOR * p.get_bitsize())
+            tonelli_shanks(ctx, a_mont, p, q, s, root);
+        else
+            cipolla(ctx, x, p, root);
+    }
+
+    //* root^2 == a, unless p was not prime.
+    ctx.mul(root, root, e);
+    ctx.reduce(e);
+    if (cmp(e, a_mont) != 0)
+        throw std::domain_error("p is not prime.");
+
+    // Return values
+    ctx.from_mont(root, ret);
+    return;
+}
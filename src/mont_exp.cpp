@@ -25,22 +25,29 @@
 *   Unfortunately, this is still slower than regular multiplication, but there
 *   is an optimized function to calculate x * R_Inv (mod m). We perform a
 *   Montgomery Reduction (or REDC). To perform this reduction, we need
-*   the value m_prime. This value can be defined by the extended gcd, or
-*   (R * R_inv + m * m_prime == 1). We also apply basic modulo to keep 
-*   m_prime positive (for future calculations).
+*   the value m_prime, the inverse of m modulo R. Since R is a power of 2,
+*   it is found by Hensel lifting instead of the extended gcd (see
+*   inv_mod_pow2.cpp). We then negate it (mod R) so that REDC only adds.
 *   
-*   For REDC, we first calculate n = ((x mod R) * m_prime) mod R.
-*   Then we recalculate x = (x - n*m) / R. These two statements allow us to 
-*   multiply by R_Inv and divide by m without having actually divided by m.
-*   Importantly, divisions by R are faster than divisions by m because R
-*   is a power of 2. This allows for x%R == x & (R-1) and x/R == x>>r_shift
-*   where R = (1 << r_shift). These are both extremely fast compared to their
-*   equivalent division functions. The newly calculated x might be negative, 
-*   so we also perform a simple modulo if that is the case.
+*   For REDC, we first calculate n = ((x mod R) * m_prime) mod R, where
+*   m_prime = -m^-1 (mod R). Then we recalculate x = (x + n*m) / R. These two
+*   statements allow us to multiply by R_Inv and divide by m without having
+*   actually divided by m. Importantly, divisions by R are faster than divisions
+*   by m because R is a power of 2. This allows for x%R == x & (R-1) and
+*   x/R == x>>r_shift where R = (1 << r_shift). These are both extremely fast
+*   compared to their equivalent division functions.
+*   
+*   The classic REDC finishes with a conditional subtraction of m to bring x
+*   into [0, m). We instead pick R > 4m, which allows every value to stay lazily
+*   reduced within [0, 2m): if x, y < 2m then x*y < 4m^2 < R*m, and so
+*   (x*y + n*m) / R < (R*m + R*m) / R = 2m. The correction (and its data-dependent
+*   branch) is skipped for every product, and only performed once when a value
+*   leaves Montgomery space. MontgomeryContext stores this setup so that chained
+*   arithmetic on the same modulus only pays for it once.
 *   
 *   During each step of the Binary Exponentiation, we replace all modulo
-*   operations with equivalent mont_redc operations. At the end of the method,
-*   we apply one last mont_redc to convert the result x' back into normal space.
+*   operations with equivalent redc operations. At the end of the method,
+*   we apply one last redc to convert the result x' back into normal space.
 *   
 *   This optimization is important because miller-rabin primality tests
 *   perform a modular exponentiation with the modulo being the candidate prime.
@@ -49,7 +56,38 @@
 */
 #include "Alginate.hpp"
 
-void mont_redc(AlgInt& x, AlgInt& temp, const AlgInt& m, const AlgInt& m_prime, const AlgInt& r_sub, size_t r_shift)
+MontgomeryContext::MontgomeryContext(const AlgInt& m)
+{
+    //? Exception block
+    if (m.get_sign() || AlgInt::cmp(m, 0) == 0)
+        throw std::domain_error("Signed or zero m not supported.");
+    if (m.get_bit(0) == 0)
+        throw std::domain_error("Even m (m % 2 == 0) not supported.");
+
+    MontgomeryContext::m = m;
+    AlgInt::add(m, m, m2);
+
+    //? Montgomery setup (R > 4m)
+    AlgInt r;
+    r_shift = m.get_bitsize() + 2;
+
+    r = 1;
+    AlgInt::bw_shl(r, r_shift, r);
+    AlgInt::sub(r, 1, r_sub);
+
+    //* m_prime = m^-1 (mod R) by Hensel lifting (see inv_mod_pow2.cpp). We need -m^-1.
+    AlgInt::inv_mod_pow2(m, r_shift, m_prime);
+    AlgInt::sub(r, m_prime, m_prime);
+
+    // r1 = R (mod m), r2 = R^2 (mod m)
+    AlgInt::mod(r, m, r1);
+    AlgInt::mul(r1, r1, r2);
+    AlgInt::mod(r2, m, r2);
+
+    return;
+}
+
+void MontgomeryContext::redc(AlgInt& x, AlgInt& temp) const
 {
     // x (mod y) where y is a power of 2 (2^a) is equal to x & (y-1)
 
@@ -60,65 +98,142 @@ void mont_redc(AlgInt& x, AlgInt& temp, const AlgInt& m, const AlgInt& m_prime,
     AlgInt::bw_and(temp, r_sub, temp);
     AlgInt::mul(temp, m, temp);
 
-    AlgInt::sub(x, temp, x);
+    //* x + n*m is divisible by R, and the result is below 2m (no correction).
+    AlgInt::add(x, temp, x);
     AlgInt::bw_shr(x, r_shift, x);
 
-    //* -x = (x - m), perform addition to fix.
-    if (x.get_sign())
-        AlgInt::add(x, m, x);
+    return;
+}
+
+void MontgomeryContext::to_mont(const AlgInt& x, AlgInt& ret) const
+{
+    AlgInt temp;
+
+    // x' = redc(x * R^2) = x * R (mod m), which requires x < m.
+    if (x.get_sign() || AlgInt::cmp(x, m) >= 0)
+    {
+        AlgInt::mod(x, m, temp);
+        AlgInt::mul(temp, r2, ret);
+    }
+    else
+        AlgInt::mul(x, r2, ret);
+
+    redc(ret, temp);
+    reduce(ret);
 
     return;
 }
 
-void AlgInt::mont_exp(const AlgInt& x, const AlgInt& y, const AlgInt& m, AlgInt& ret)
+void MontgomeryContext::from_mont(const AlgInt& x, AlgInt& ret) const
 {
-    //? Exception block
-    if (x.sign || y.sign || m.sign)
-        throw std::domain_error("Signed x, y, m not supported.");
-    if ((m.num[0] & 1) == 0)
-        throw std::domain_error("Even m (m % 2 == 0) not supported.");
+    AlgInt temp;
+    ret = x;
 
-    //? Montgomery setup
-    AlgInt r, r_sub, r_inv, m_prime;
-    size_t r_shift = m.get_bitsize();
+    //* redc(x) for x < 2m is within [0, m], so m itself is the only value left to fix.
+    redc(ret, temp);
+    reduce(ret);
 
-    r = 1;
-    bw_shl(r, r_shift, r);
-    sub(r, 1, r_sub);
+    return;
+}
 
-    ext_gcd(r, m, r_inv, m_prime);
-    if (m_prime.sign)
-        sub(r, m_prime, m_prime, true);
+void MontgomeryContext::reduce(AlgInt& x) const
+{
+    if (AlgInt::cmp(x, m) >= 0)
+        AlgInt::sub(x, m, x);
 
-    // sqr = x * r (mod m)
-    AlgInt sqr;
-    mul(x, r, sqr);
-    mod(sqr, m, sqr);
+    return;
+}
+
+void MontgomeryContext::mul(const AlgInt& x, const AlgInt& y, AlgInt& ret) const
+{
+    AlgInt temp;
+    AlgInt::mul(x, y, ret);
+    redc(ret, temp);
 
-    // tret = 1 * r (mod m)
-    AlgInt tret = r;
-    mod(tret, m, tret);
+    return;
+}
+
+void MontgomeryContext::add(const AlgInt& x, const AlgInt& y, AlgInt& ret) const
+{
+    // x + y < 4m
+    AlgInt::add(x, y, ret);
+    if (AlgInt::cmp(ret, m2) >= 0)
+        AlgInt::sub(ret, m2, ret);
+
+    return;
+}
+
+void MontgomeryContext::sub(const AlgInt& x, const AlgInt& y, AlgInt& ret) const
+{
+    // x - y + 2m is within (0, 4m)
+    AlgInt temp;
+    AlgInt::add(x, m2, temp);
+    AlgInt::sub(temp, y, ret);
+    if (AlgInt::cmp(ret, m2) >= 0)
+        AlgInt::sub(ret, m2, ret);
+
+    return;
+}
+
+void MontgomeryContext::exp(const AlgInt& x, const AlgInt& y, AlgInt& ret) const
+{
+    if (y.get_sign())
+        throw std::domain_error("Negative y not supported.");
+
+    AlgInt sqr = x;
+    AlgInt tret = r1;
 
     //? Primary exponentiation loop
-    AlgInt t1;
+    AlgInt temp;
     for (size_t i = 0; i < y.get_bitsize(); i++)
     {
         // If the current bit is 1, multiply compounded x.
         if (y.get_bit(i) == 1)
         {
-            mul(tret, sqr, tret);
-            mont_redc(tret, t1, m, m_prime, r_sub, r_shift);
+            AlgInt::mul(tret, sqr, tret);
+            redc(tret, temp);
         }
 
         // sqr = sqr*sqr
-        mul(sqr, sqr, sqr);
-        mont_redc(sqr, t1, m, m_prime, r_sub, r_shift);
+        AlgInt::mul(sqr, sqr, sqr);
+        redc(sqr, temp);
     }
 
-    //* Convert tret' into tret (montgomery space -> normal space)
-    mont_redc(tret, t1, m, m_prime, r_sub, r_shift);
-
     // Return values
-    AlgInt::swap(tret, ret);
+    ret = std::move(tret);
+    return;
+}
+
+const AlgInt& MontgomeryContext::one() const
+{
+    return r1;
+}
+
+const AlgInt& MontgomeryContext::get_mod() const
+{
+    return m;
+}
+
+void AlgInt::mont_exp(const AlgInt& x, const AlgInt& y, const AlgInt& m, AlgInt& ret)
+{
+    //? Exception block
+    if (x.sign || y.sign || m.sign)
+        throw std::domain_error("Signed x, y, m not supported.");
+    if ((m.num[0] & 1) == 0)
+        throw std::domain_error("Even m (m % 2 == 0) not supported.");
+
+    //? Montgomery setup
+    MontgomeryContext ctx(m);
+
+    // sqr = x * r (mod m)
+    AlgInt sqr;
+    ctx.to_mont(x, sqr);
+
+    //? Primary exponentiation loop (lazily reduced)
+    AlgInt tret;
+    ctx.exp(sqr, y, tret);
+
+    //* Convert tret' into tret (montgomery space -> normal space)
+    ctx.from_mont(tret, ret);
     return;
-}
\ No newline at end of file
+}
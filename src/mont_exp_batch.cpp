@@ -0,0 +1,225 @@
+/**
+*   File: mont_exp_batch.cpp
+*   Project: Alginate
+*   SPDX-License-Identifier: Unlicense
+*
+*   Batched Montgomery exponentiation runs several independent exponentiations
+*   (one per "lane") in lockstep. Every lane performs exactly the same sequence
+*   of operations, only on different data, which is the shape that SIMD units
+*   (AVX2, AVX-512) are built for. The digits of all lanes are interleaved in
+*   column-major order: digit j of lane l is stored at [j*LANES + l]. The
+*   innermost loop of every kernel walks the lanes of a single digit, so each
+*   of its iterations is a single vector instruction once compiled for a vector
+*   target (see the ALGINATE_NATIVE CMake option).
+*
+*   Montgomery multiplication is performed digit by digit (CIOS, Coarsely
+*   Integrated Operand Scanning) with R = 2^(32*n), where n is the digit count
+*   of every modulus. For each digit b[i] we add a*b[i] into t, then add q*m
+*   where q = t[0] * m' (mod 2^32) was chosen to clear the lowest digit, which
+*   allows t to be shifted down by a digit. This only requires the single-digit
+*   inverse m' = -m^-1 (mod 2^32) per lane. The result is below 2m, and the
+*   final subtraction of m is selected per lane with a mask instead of a branch.
+*
+*   The exponents of each lane differ, but the sequence of operations may not.
+*   We use fixed-window exponentiation: every window of WINDOW bits costs WINDOW
+*   squarings and a single multiplication by a table entry, regardless of its
+*   value. Each lane gathers its own table entry (table[0] is 1 in Montgomery
+*   space), so a zero window still performs a (useless) multiplication.
+*/
+#include "Alginate.hpp"
+#include <algorithm>
+
+// The lane count matches the vector width (64-bit products per lane).
+#if defined(__AVX512F__)
+constexpr size_t LANES = 8;
+#else
+constexpr size_t LANES = 4;
+#endif
+
+// Exponent bits processed per table multiplication.
+constexpr size_t WINDOW = 4;
+
+// ret = a * b * R^-1 (mod m) in every lane. t must hold (n+2) digits per lane. ret may overlap with a or b.
+static void mont_mul_lanes(const uint32_t* a, const uint32_t* b, const uint32_t* m, const uint32_t* m_inv, size_t n, uint32_t* __restrict t, uint32_t* ret)
+{
+    uint64_t carry[LANES];
+    uint32_t q[LANES];
+
+    for (size_t i = 0; i < (n+2)*LANES; i++)
+        t[i] = 0;
+
+    //? Primary CIOS loop
+    for (size_t i = 0; i < n; i++)
+    {
+        const uint32_t* b_i = b + i*LANES;
+
+        //* t += a * b[i]
+        for (size_t l = 0; l < LANES; l++)
+            carry[l] = 0;
+        for (size_t j = 0; j < n; j++)
+        {
+            for (size_t l = 0; l < LANES; l++)
+            {
+                uint64_t calc = (uint64_t) a[j*LANES + l] * b_i[l] + t[j*LANES + l] + carry[l];
+                t[j*LANES + l] = (uint32_t) calc;
+                carry[l] = calc >> 32;
+            }
+        }
+        for (size_t l = 0; l < LANES; l++)
+        {
+            uint64_t calc = (uint64_t) t[n*LANES + l] + carry[l];
+            t[n*LANES + l] = (uint32_t) calc;
+            t[(n+1)*LANES + l] = calc >> 32;
+        }
+
+        //* t = (t + q*m) / 2^32, where q clears the lowest digit of t.
+        for (size_t l = 0; l < LANES; l++)
+        {
+            q[l] = t[l] * m_inv[l];
+            carry[l] = ((uint64_t) q[l] * m[l] + t[l]) >> 32;
+        }
+        for (size_t j = 1; j < n; j++)
+        {
+            for (size_t l = 0; l < LANES; l++)
+            {
+                uint64_t calc = (uint64_t) q[l] * m[j*LANES + l] + t[j*LANES + l] + carry[l];
+                t[(j-1)*LANES + l] = (uint32_t) calc;
+                carry[l] = calc >> 32;
+            }
+        }
+        for (size_t l = 0; l < LANES; l++)
+        {
+            uint64_t calc = (uint64_t) t[n*LANES + l] + carry[l];
+            t[(n-1)*LANES + l] = (uint32_t) calc;
+            t[n*LANES + l] = t[(n+1)*LANES + l] + (uint32_t) (calc >> 32);
+        }
+    }
+
+    //? Final subtraction (t < 2m), selected per lane.
+    uint32_t borrow[LANES];
+    for (size_t l = 0; l < LANES; l++)
+        borrow[l] = 0;
+    for (size_t j = 0; j < n; j++)
+    {
+        for (size_t l = 0; l < LANES; l++)
+        {
+            uint64_t calc = (uint64_t) t[j*LANES + l] - m[j*LANES + l] - borrow[l];
+            ret[j*LANES + l] = (uint32_t) calc;
+            borrow[l] = (calc >> 32) & 1;
+        }
+    }
+
+    //* If t - m underflows (t < m), keep t instead.
+    for (size_t l = 0; l < LANES; l++)
+        borrow[l] = -(uint32_t) (t[n*LANES + l] < borrow[l]);
+    for (size_t j = 0; j < n; j++)
+    {
+        for (size_t l = 0; l < LANES; l++)
+            ret[j*LANES + l] = (t[j*LANES + l] & borrow[l]) | (ret[j*LANES + l] & ~borrow[l]);
+    }
+
+    return;
+}
+
+void AlgInt::mont_exp_batch(const std::vector<AlgInt>& x, const std::vector<AlgInt>& y, const std::vector<AlgInt>& m, std::vector<AlgInt>& ret)
+{
+    //? Exception block
+    if (x.size() != y.size() || x.size() != m.size())
+        throw std::domain_error("x, y, and m must contain the same number of AlgInts.");
+    for (size_t i = 0; i < m.size(); i++)
+    {
+        if (x[i].sign || y[i].sign || m[i].sign)
+            throw std::domain_error("Signed x, y, m not supported.");
+        if (m[i].size == 0 || (m[i].num[0] & 1) == 0)
+            throw std::domain_error("Even m (m % 2 == 0) not supported.");
+        if (m[i].size != m[0].size)
+            throw std::domain_error("All m must have the same number of digits.");
+    }
+
+    std::vector<AlgInt> tret(m.size());
+    size_t n = (m.size()) ? m[0].size : 0;
+
+    // Column-major lane buffers
+    std::vector<uint32_t> mods(n*LANES), acc(n*LANES), operand(n*LANES), t((n+2)*LANES);
+    std::vector<uint32_t> table((1 << WINDOW) * n*LANES);
+    uint32_t m_inv[LANES];
+
+    //? Process LANES exponentiations at a time
+    for (size_t first = 0; first < m.size(); first += LANES)
+    {
+        //? Lane setup (unused lanes repeat the first exponentiation)
+        size_t max_bits = 0;
+        AlgInt r, temp;
+        for (size_t l = 0; l < LANES; l++)
+        {
+            size_t k = (first + l < m.size()) ? first + l : first;
+            max_bits = std::max(max_bits, y[k].get_bitsize());
+
+            // m' = -m^-1 (mod 2^32)
+            m_inv[l] = -(uint32_t) inv_u64(m[k].num[0]);
+
+            // table[0] = R (mod m), table[1] = x*R (mod m)
+            r = 0;
+            r.set_bit(32*n);
+            mod(r, m[k], r);
+            mod(x[k], m[k], temp);
+            bw_shl(temp, 32*n, temp);
+            mod(temp, m[k], temp);
+
+            for (size_t j = 0; j < n; j++)
+            {
+                mods[j*LANES + l] = m[k].num[j];
+                table[j*LANES + l] = (j < r.size) ? r.num[j] : 0;
+                table[(n + j)*LANES + l] = (j < temp.size) ? temp.num[j] : 0;
+            }
+        }
+
+        // table[e] = table[e-1] * x
+        for (size_t e = 2; e < (1 << WINDOW); e++)
+            mont_mul_lanes(&table[(e-1)*n*LANES], &table[n*LANES], mods.data(), m_inv, n, t.data(), &table[e*n*LANES]);
+
+        //? Primary fixed-window exponentiation loop (MSW first)
+        std::copy(table.begin(), table.begin() + n*LANES, acc.begin());
+        size_t windows = (max_bits + WINDOW - 1) / WINDOW;
+        for (size_t w = windows; w-- > 0;)
+        {
+            if (w + 1 < windows)
+            {
+                for (size_t i = 0; i < WINDOW; i++)
+                    mont_mul_lanes(acc.data(), acc.data(), mods.data(), m_inv, n, t.data(), acc.data());
+            }
+
+            //* Each lane gathers its own table entry.
+            for (size_t l = 0; l < LANES; l++)
+            {
+                size_t k = (first + l < m.size()) ? first + l : first;
+                size_t bit = w * WINDOW;
+                uint32_t digit = ((bit >> 5) < y[k].size) ? (y[k].num[bit >> 5] >> (bit & 0x1F)) & ((1 << WINDOW) - 1) : 0;
+
+                for (size_t j = 0; j < n; j++)
+                    operand[j*LANES + l] = table[(digit*n + j)*LANES + l];
+            }
+            mont_mul_lanes(acc.data(), operand.data(), mods.data(), m_inv, n, t.data(), acc.data());
+        }
+
+        //* Convert out of Montgomery space (multiply by 1).
+        std::fill(operand.begin(), operand.end(), 0);
+        for (size_t l = 0; l < LANES; l++)
+            operand[l] = 1;
+        mont_mul_lanes(acc.data(), operand.data(), mods.data(), m_inv, n, t.data(), acc.data());
+
+        //? Lane teardown
+        for (size_t l = 0; l < LANES && first + l < m.size(); l++)
+        {
+            AlgInt& lane = tret[first + l];
+            lane.resize(n);
+            for (size_t j = 0; j < n; j++)
+                lane.num[j] = acc[j*LANES + l];
+            lane.trunc();
+        }
+    }
+
+    // Return values
+    std::swap(ret, tret);
+    return;
+}
@@ -14,36 +14,164 @@
 *   Additionally, by splitting the number, Karatsuba allows for parallel computation;
 *   however, there are no plans to take advantage of this optimization in this library.
 *   
-*   Karatsuba works by:
-*   ! Update when we write a karatsuba optimization.
+*   Karatsuba works by splitting both numbers at the same digit: x = x1*B + x0 and
+*   y = y1*B + y0. Then x*y = z2*B^2 + z1*B + z0, where z2 = x1*y1, z0 = x0*y0 and
+*   z1 = x0*y1 + x1*y0. The trick is that z1 = (x0 + x1)(y0 + y1) - z2 - z0, which
+*   only requires a single multiplication (instead of two). Every multiplication is
+*   performed directly on digit arrays, so the recursion never creates an AlgInt.
+*   Karatsuba requires both numbers to be the same length. If one is much longer,
+*   it is split into pieces as long as the shorter number, which are multiplied
+*   separately and added together at their offsets.
 */
 #include "Alginate.hpp"
+#include <vector>
 
-void AlgInt::mul(const AlgInt& x, const AlgInt& y, AlgInt& ret, bool unsign)
-{
-    // Basic temp setup
-    AlgInt tret;
-    tret.resize(x.size+y.size);
-    tret.sign = (x.sign ^ y.sign) && !unsign;
+// Numbers with fewer digits than this are multiplied with schoolbook multiplication.
+constexpr size_t KARATSUBA_THRESHOLD = 32;
 
-    // Create reference variables based on digit (not absolute) size.
-    const AlgInt& big = (x.size > y.size) ? x : y;
-    const AlgInt& sml = (x.size > y.size) ? y : x;
+// ret[0, an+bn) = a * b. ret must not overlap with a or b.
+static void mul_school(const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* ret)
+{
+    for (size_t i = 0; i < an + bn; i++)
+        ret[i] = 0;
 
-    //? Primary multiplication loop
-    for (size_t i = 0; i < sml.size; i++)
+    for (size_t i = 0; i < bn; i++)
     {
         //* calc also serves as a carry from previous mul/add loop
         uint64_t calc = 0;
-        for (size_t j = 0; j < big.size; j++)
+        for (size_t j = 0; j < an; j++)
         {
-            calc += (uint64_t) big.num[j] * sml.num[i] + tret.num[i + j];
+            calc += (uint64_t) a[j] * b[i] + ret[i + j];
 
-            tret.num[i + j] = (uint32_t) calc;
+            ret[i + j] = (uint32_t) calc;
             calc >>= 32;
         }
-        tret.num[i + big.size] = calc;
+        ret[i + an] = calc;
+    }
+
+    return;
+}
+
+// x[0, xn) += y[0, yn), where xn >= yn. Returns the carry out of x.
+static uint32_t add_digits(uint32_t* x, size_t xn, const uint32_t* y, size_t yn)
+{
+    uint64_t carry = 0;
+    size_t i;
+    for (i = 0; i < yn; i++)
+    {
+        carry += (uint64_t) x[i] + y[i];
+        x[i] = (uint32_t) carry;
+        carry >>= 32;
+    }
+    for (; carry && i < xn; i++)
+    {
+        carry += x[i];
+        x[i] = (uint32_t) carry;
+        carry >>= 32;
+    }
+
+    return carry;
+}
+
+// x[0, xn) -= y[0, yn), where x >= y.
+static void sub_digits(uint32_t* x, size_t xn, const uint32_t* y, size_t yn)
+{
+    uint64_t borrow = 0;
+    size_t i;
+    for (i = 0; i < yn; i++)
+    {
+        uint64_t calc = (uint64_t) x[i] - y[i] - borrow;
+        x[i] = (uint32_t) calc;
+        borrow = (calc >> 32) & 1;
+    }
+    for (; borrow && i < xn; i++)
+    {
+        borrow = (x[i] == 0);
+        x[i]--;
+    }
+
+    return;
+}
+
+static void mul_digits(const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* ret);
+
+// ret[0, 2n) = a * b, where a and b are both n digits.
+static void mul_karatsuba(const uint32_t* a, const uint32_t* b, size_t n, uint32_t* ret)
+{
+    if (n < KARATSUBA_THRESHOLD)
+        return mul_school(a, n, b, n, ret);
+
+    // x = x1*B^lo + x0, where x0 has lo digits and x1 has hi digits.
+    size_t lo = n - n/2;
+    size_t hi = n/2;
+
+    //* z0 and z2 are written directly into their final places in ret.
+    mul_karatsuba(a, b, lo, ret);
+    mul_digits(a + lo, hi, b + lo, hi, ret + 2*lo);
+
+    // (x0 + x1) and (y0 + y1) each require up to lo+1 digits.
+    std::vector<uint32_t> sums(2*(lo+1)), z1(2*(lo+1));
+    uint32_t* a_sum = sums.data();
+    uint32_t* b_sum = sums.data() + lo+1;
+    for (size_t i = 0; i < lo; i++)
+    {
+        a_sum[i] = a[i];
+        b_sum[i] = b[i];
     }
+    a_sum[lo] = add_digits(a_sum, lo, a + lo, hi);
+    b_sum[lo] = add_digits(b_sum, lo, b + lo, hi);
+
+    //? z1 = (x0 + x1)(y0 + y1) - z2 - z0
+    mul_karatsuba(a_sum, b_sum, lo+1, z1.data());
+    sub_digits(z1.data(), 2*(lo+1), ret, 2*lo);
+    sub_digits(z1.data(), 2*(lo+1), ret + 2*lo, 2*hi);
+
+    // ret += z1*B^lo (z1 fits, because the full product does)
+    size_t z1_size = 2*(lo+1);
+    while (z1_size && z1[z1_size-1] == 0)
+        z1_size--;
+    add_digits(ret + lo, 2*n - lo, z1.data(), z1_size);
+
+    return;
+}
+
+// ret[0, an+bn) = a * b. ret must not overlap with a or b.
+static void mul_digits(const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* ret)
+{
+    //* a is always the longer number.
+    if (an < bn)
+        return mul_digits(b, bn, a, an, ret);
+
+    if (bn < KARATSUBA_THRESHOLD)
+        return mul_school(a, an, b, bn, ret);
+    if (an == bn)
+        return mul_karatsuba(a, b, an, ret);
+
+    //? Unbalanced: a is multiplied in pieces of bn digits.
+    for (size_t i = 0; i < an + bn; i++)
+        ret[i] = 0;
+
+    std::vector<uint32_t> piece(2*bn);
+    for (size_t offset = 0; offset < an; offset += bn)
+    {
+        size_t piece_size = (an - offset < bn) ? an - offset : bn;
+        mul_digits(a + offset, piece_size, b, bn, piece.data());
+        add_digits(ret + offset, an + bn - offset, piece.data(), piece_size + bn);
+    }
+
+    return;
+}
+
+void AlgInt::mul(const AlgInt& x, const AlgInt& y, AlgInt& ret, bool unsign)
+{
+    // Basic temp setup
+    AlgInt tret;
+    tret.resize(x.size+y.size);
+    tret.sign = (x.sign ^ y.sign) && !unsign;
+
+    //? Primary multiplication (schoolbook or karatsuba, by size)
+    if (x.size && y.size)
+        mul_digits(x.num, x.size, y.num, y.size, tret.num);
 
     // Remove leading zeroes.
     tret.trunc();
@@ -62,13 +190,14 @@ void AlgInt::mul(const AlgInt& x, uint32_t y, AlgInt& ret, bool unsign)
 
     //? Primary multiplication loop (single digit w/ carry)
     uint32_t carry = 0;
-    for (size_t i = 0; i < temp.size; i++)
+    for (size_t i = 0; i < x.size; i++)
     {
         uint64_t calc = (uint64_t) x.num[i] * y + carry;
         
         carry = (calc >> 32);
         temp.num[i] +=  (uint32_t) calc;
     }
+    temp.num[x.size] = carry;
 
     // Remove leading zeroes.
     temp.trunc();
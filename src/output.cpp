@@ -27,6 +27,10 @@ bool AlgInt::get_sign() const
 
 size_t AlgInt::get_bitsize() const
 {
+    // Canonical zero has no bits (and no num array).
+    if (size == 0)
+        return 0;
+
     size_t tmp = 0;
     uint32_t msw = num[size-1];
 
@@ -165,6 +169,15 @@ size_t AlgInt::output_arr_base2pow32(uint32_t*& arr)
     return size;
 }
 
+uint64_t AlgInt::output_uint64() const
+{
+    uint64_t out = (size > 0) ? num[0] : 0;
+    if (size > 1)
+        out |= (uint64_t) num[1] << 32;
+
+    return out;
+}
+
 std::ostream& operator<<(std::ostream& out, const AlgInt& obj)
 { 
     //* We return the resulting ostream to allow chaining (std::cout << 1 << 2).
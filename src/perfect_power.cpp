@@ -0,0 +1,121 @@
+/**
+*   File: perfect_power.cpp
+*   Project: Alginate
+*   SPDX-License-Identifier: Unlicense
+*
+*   x is a perfect power if x = b^k for some k >= 2. If so, it is also a p-th
+*   power for every prime p dividing k, so only prime exponents are tested,
+*   and b >= 2 limits them to p <= log2(x). Once a p-th root is found, the
+*   search continues on the root itself, which yields the largest k (and the
+*   smallest base).
+*
+*   Computing a root is the expensive part of a test, so every exponent is
+*   screened with cheap necessary conditions first:
+*
+*     - The number of trailing zero bits of a p-th power is divisible by p.
+*     - For a prime q == 1 (mod p), only one in p nonzero residues (mod q) is a
+*       p-th power: r is a p-th power exactly if r^((q-1)/p) == 1 (mod q).
+*       Each such q costs a single pass over the digits of x (x mod q), and
+*       a few of them reject almost every exponent of a random x.
+*
+*   Only the exponents that survive every screen compute floor(x^(1/p)) (see
+*   root.cpp) and compare its p-th power to x.
+*/
+#include "Alginate.hpp"
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+// Residue screens (primes q == 1 (mod p)) per exponent p.
+constexpr size_t SCREEN_PRIMES = 4;
+
+// Returns b^e (mod m) for a native m.
+static uint64_t pow_mod_u64(uint64_t b, uint64_t e, uint64_t m)
+{
+    uint64_t result = 1;
+    b %= m;
+    while (e)
+    {
+        if (e & 1)
+            result = (uint64_t) ((uint128_t) result * b % m);
+        b = (uint64_t) ((uint128_t) b * b % m);
+        e >>= 1;
+    }
+
+    return result;
+}
+
+// Returns false if x can not be a p-th power, judged by its residues modulo small primes.
+static bool power_residue_screen(const AlgInt& x, uint32_t p)
+{
+    //* q == 1 (mod p) and odd, so q == 1 (mod 2p).
+    size_t found = 0;
+    for (uint64_t q = 2*(uint64_t) p + 1; found < SCREEN_PRIMES && q <= UINT32_MAX; q += 2*p)
+    {
+        if (!AlgInt::is_prime_u64(q))
+            continue;
+        found++;
+
+        uint32_t r = AlgInt::mod(x, (uint32_t) q, true);
+        if (r && pow_mod_u64(r, (q - 1) / p, q) != 1)
+            return false;
+    }
+
+    return true;
+}
+
+bool AlgInt::is_perfect_power(const AlgInt& x, AlgInt& base, uint32_t& k)
+{
+    //? 0 = 0^2, 1 = 1^2 and -1 = (-1)^3
+    if (x.size == 0 || (x.size == 1 && x.num[0] == 1))
+    {
+        base = x;
+        k = (x.sign) ? 3 : 2;
+        return true;
+    }
+
+    //* Negative numbers can only be odd powers, which are found for |x|.
+    AlgInt tbase = x, root, pow, exponent;
+    tbase.sign = false;
+    uint32_t tk = 1;
+
+    size_t zeros = 0;
+    while (tbase.num[zeros >> 5] == 0)
+        zeros += 32;
+    zeros += __builtin_ctz(tbase.num[zeros >> 5]);
+
+    //? Prime exponents up to log2(x), where every root restarts at the same exponent.
+    uint32_t p = (x.sign) ? 3 : 2;
+    while (p < tbase.get_bitsize())
+    {
+        if (zeros % p == 0 && power_residue_screen(tbase, p))
+        {
+            iroot(tbase, p, root);
+            exponent = p;
+            exp(root, exponent, pow);
+            if (cmp(pow, tbase) == 0)
+            {
+                swap(tbase, root);
+                tk *= p;
+                zeros /= p;
+                continue;
+            }
+        }
+
+        do
+            p++;
+        while (!is_prime_u64(p));
+    }
+
+    if (tk == 1)
+    {
+        base = x;
+        k = 1;
+        return false;
+    }
+
+    // Return values
+    tbase.sign = x.sign;
+    swap(tbase, base);
+    k = tk;
+    return true;
+}
@@ -0,0 +1,348 @@
+/**
+*   File: prime.cpp
+*   Project: Alginate
+*   SPDX-License-Identifier: Unlicense
+*
+*   Primes are found by searching upwards from a starting point (random for
+*   random_prime()). Most candidates have a small prime factor, which is far
+*   cheaper to detect than running Miller-Rabin. Rather than trial dividing
+*   every candidate by every small prime (one full-length division each), the
+*   candidates are sieved over an interval, like the sieve of Eratosthenes.
+*
+*   The residues of the interval's base (base mod p) are computed once for
+*   every small prime p. The odd candidate base + 2i is divisible by p exactly
+*   when 2i == -(base mod p) (mod p), so every multiple of p in the interval is
+*   found directly from the residue and then stepped through p at a time. When
+*   the interval is exhausted, the base moves up by the interval length and the
+*   residues are updated with a single-digit addition, so no full-length
+*   division is ever repeated. Only the candidates that survive the sieve
+*   (about 1 in 8) are tested with Miller-Rabin, so the candidate rate is set by
+*   Miller-Rabin rather than by trial division.
+*
+*   Candidates below the square of the largest sieve prime are certainly prime
+*   once they survive the sieve, and skip Miller-Rabin entirely.
+*
+*   Safe primes p = 2q+1 sieve q and p together: q is removed when either
+*   q == 0 or 2q+1 == 0 modulo a small prime, which is a second residue class
+*   per prime in the same interval. Survivors (about 1 in 60) must pass a base
+*   2 Miller-Rabin round on both q and p before q is given any further rounds,
+*   so nearly all of the work is spent on a single exponentiation each.
+*
+*   The search for a random prime is embarrassingly parallel. In the parallel
+*   mode every worker thread searches upwards from its own random start (drawn
+*   from its own random function), and the first worker to find a prime claims
+*   it through an atomic flag. The other workers check that flag before every
+*   candidate and between Miller-Rabin rounds, so they stop almost immediately.
+*/
+#include "Alginate.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+// Odd primes used by the sieve. The amount is arbitrary.
+constexpr uint32_t SIEVE_PRIMES[1000] = {3,5,7,11,13,17,19,23,29,31,37,41,43,47,53,59,61,67,71,73,79,83,89,97,101,103,107,109,113,127,131,137,139,149,151,157,163,167,173,179,181,191,193,197,199,211,223,227,229,233,239,241,251,257,263,269,271,277,281,283,293,307,311,313,317,331,337,347,349,353,359,367,373,379,383,389,397,401,409,419,421,431,433,439,443,449,457,461,463,467,479,487,491,499,503,509,521,523,541,547,557,563,569,571,577,587,593,599,601,607,613,617,619,631,641,643,647,653,659,661,673,677,683,691,701,709,719,727,733,739,743,751,757,761,769,773,787,797,809,811,821,823,827,829,839,853,857,859,863,877,881,883,887,907,911,919,929,937,941,947,953,967,971,977,983,991,997,1009,1013,1019,1021,1031,1033,1039,1049,1051,1061,1063,1069,1087,1091,1093,1097,1103,1109,1117,1123,1129,1151,1153,1163,1171,1181,1187,1193,1201,1213,1217,1223,1229,1231,1237,1249,1259,1277,1279,1283,1289,1291,1297,1301,1303,1307,1319,1321,1327,1361,1367,1373,1381,1399,1409,1423,1427,1429,1433,1439,1447,1451,1453,1459,1471,1481,1483,1487,1489,1493,1499,1511,1523,1531,1543,1549,1553,1559,1567,1571,1579,1583,1597,1601,1607,1609,1613,1619,1621,1627,1637,1657,1663,1667,1669,1693,1697,1699,1709,1721,1723,1733,1741,1747,1753,1759,1777,1783,1787,1789,1801,1811,1823,1831,1847,1861,1867,1871,1873,1877,1879,1889,1901,1907,1913,1931,1933,1949,1951,1973,1979,1987,1993,1997,1999,2003,2011,2017,2027,2029,2039,2053,2063,2069,2081,2083,2087,2089,2099,2111,2113,2129,2131,2137,2141,2143,2153,2161,2179,2203,2207,2213,2221,2237,2239,2243,2251,2267,2269,2273,2281,2287,2293,2297,2309,2311,2333,2339,2341,2347,2351,2357,2371,2377,2381,2383,2389,2393,2399,2411,2417,2423,2437,2441,2447,2459,2467,2473,2477,2503,2521,2531,2539,2543,2549,2551,2557,2579,2591,2593,2609,2617,2621,2633,2647,2657,2659,2663,2671,2677,2683,2687,2689,2693,2699,2707,2711,2713,2719,2729,2731,2741,2749,2753,2767,2777,2789,2791,2797,2801,2803,2819,2833,2837,2843,2851,2857,2861,2879,2887,2897,2903,2909,2917,2927,2939,2953,2957,2963,2969,2971,2999,3001,3011,3019,3023,3037,3041,3049,3061,3067,3079,3083,3089,3109,3119,3121,3137,3163,3167,3169,3181,3187,3191,3203,3209,3217,3221,3229,3251,3253,3257,3259,3271,3299,3301,3307,3313,3319,3323,3329,3331,3343,3347,3359,3361,3371,3373,3389,3391,3407,3413,3433,3449,3457,3461,3463,3467,3469,3491,3499,3511,3517,3527,3529,3533,3539,3541,3547,3557,3559,3571,3581,3583,3593,3607,3613,3617,3623,3631,3637,3643,3659,3671,3673,3677,3691,3697,3701,3709,3719,3727,3733,3739,3761,3767,3769,3779,3793,3797,3803,3821,3823,3833,3847,3851,3853,3863,3877,3881,3889,3907,3911,3917,3919,3923,3929,3931,3943,3947,3967,3989,4001,4003,4007,4013,4019,4021,4027,4049,4051,4057,4073,4079,4091,4093,4099,4111,4127,4129,4133,4139,4153,4157,4159,4177,4201,4211,4217,4219,4229,4231,4241,4243,4253,4259,4261,4271,4273,4283,4289,4297,4327,4337,4339,4349,4357,4363,4373,4391,4397,4409,4421,4423,4441,4447,4451,4457,4463,4481,4483,4493,4507,4513,4517,4519,4523,4547,4549,4561,4567,4583,4591,4597,4603,4621,4637,4639,4643,4649,4651,4657,4663,4673,4679,4691,4703,4721,4723,4729,4733,4751,4759,4783,4787,4789,4793,4799,4801,4813,4817,4831,4861,4871,4877,4889,4903,4909,4919,4931,4933,4937,4943,4951,4957,4967,4969,4973,4987,4993,4999,5003,5009,5011,5021,5023,5039,5051,5059,5077,5081,5087,5099,5101,5107,5113,5119,5147,5153,5167,5171,5179,5189,5197,5209,5227,5231,5233,5237,5261,5273,5279,5281,5297,5303,5309,5323,5333,5347,5351,5381,5387,5393,5399,5407,5413,5417,5419,5431,5437,5441,5443,5449,5471,5477,5479,5483,5501,5503,5507,5519,5521,5527,5531,5557,5563,5569,5573,5581,5591,5623,5639,5641,5647,5651,5653,5657,5659,5669,5683,5689,5693,5701,5711,5717,5737,5741,5743,5749,5779,5783,5791,5801,5807,5813,5821,5827,5839,5843,5849,5851,5857,5861,5867,5869,5879,5881,5897,5903,5923,5927,5939,5953,5981,5987,6007,6011,6029,6037,6043,6047,6053,6067,6073,6079,6089,6091,6101,6113,6121,6131,6133,6143,6151,6163,6173,6197,6199,6203,6211,6217,6221,6229,6247,6257,6263,6269,6271,6277,6287,6299,6301,6311,6317,6323,6329,6337,6343,6353,6359,6361,6367,6373,6379,6389,6397,6421,6427,6449,6451,6469,6473,6481,6491,6521,6529,6547,6551,6553,6563,6569,6571,6577,6581,6599,6607,6619,6637,6653,6659,6661,6673,6679,6689,6691,6701,6703,6709,6719,6733,6737,6761,6763,6779,6781,6791,6793,6803,6823,6827,6829,6833,6841,6857,6863,6869,6871,6883,6899,6907,6911,6917,6947,6949,6959,6961,6967,6971,6977,6983,6991,6997,7001,7013,7019,7027,7039,7043,7057,7069,7079,7103,7109,7121,7127,7129,7151,7159,7177,7187,7193,7207,7211,7213,7219,7229,7237,7243,7247,7253,7283,7297,7307,7309,7321,7331,7333,7349,7351,7369,7393,7411,7417,7433,7451,7457,7459,7477,7481,7487,7489,7499,7507,7517,7523,7529,7537,7541,7547,7549,7559,7561,7573,7577,7583,7589,7591,7603,7607,7621,7639,7643,7649,7669,7673,7681,7687,7691,7699,7703,7717,7723,7727,7741,7753,7757,7759,7789,7793,7817,7823,7829,7841,7853,7867,7873,7877,7879,7883,7901,7907,7919,7927};
+constexpr size_t SIEVE_PRIME_COUNT = sizeof(SIEVE_PRIMES) / sizeof(SIEVE_PRIMES[0]);
+constexpr uint32_t SIEVE_PRIME_MAX = SIEVE_PRIMES[SIEVE_PRIME_COUNT - 1];
+
+// Candidates below this limit that survive the sieve are certainly prime.
+constexpr uint32_t SIEVE_LIMIT = SIEVE_PRIME_MAX * SIEVE_PRIME_MAX;
+
+// Odd candidates per sieve interval.
+constexpr uint32_t SIEVE_SPAN = 4096;
+
+// Miller-Rabin rounds after the base 2 round.
+// est. probability of false prime: 4**(-24)
+constexpr size_t PRIME_MR_ROUNDS = 24;
+
+// Miller-Rabin with random witnesses (or the sieve primes if randfunc is nullptr), after the base 2 round.
+// Returns false early if cancel is set.
+static bool mr_rounds(const MillerRabinContext& mr, uint32_t(*randfunc)(), const std::atomic<bool>* cancel)
+{
+    // The witness stays below cand - 1, since it has fewer bits than cand.
+    size_t wit_size = (mr.get_candidate().get_bitsize() - 1) / 32;
+    AlgInt wit;
+
+    for (size_t i = 0; i < PRIME_MR_ROUNDS; i++)
+    {
+        if (cancel && cancel->load(std::memory_order_relaxed))
+            return false;
+
+        if (randfunc)
+        {
+            wit = AlgInt(wit_size, randfunc);
+            if (wit < 2)
+                wit = 2;
+        }
+        else
+            wit = SIEVE_PRIMES[i];
+
+        if (!mr.test(wit))
+            return false;
+    }
+
+    return true;
+}
+
+// Miller-Rabin with base 2, then PRIME_MR_ROUNDS further rounds.
+// Returns false early if cancel is set.
+static bool probable_prime(const AlgInt& cand, uint32_t(*randfunc)(), const std::atomic<bool>* cancel)
+{
+    //* Candidates that fit in 64 bits are decided exactly with native integers.
+    if (cand.get_bitsize() <= 64)
+        return AlgInt::is_prime_u64(cand.output_uint64());
+
+    //* The candidate's setup is shared by every round.
+    MillerRabinContext mr(cand);
+    if (!mr.test(2))
+        return false;
+
+    return mr_rounds(mr, randfunc, cancel);
+}
+
+// ret = the smallest prime above x. Returns false (ret is unchanged) if the search was cancelled.
+static bool prime_search(const AlgInt& x, uint32_t(*randfunc)(), const std::atomic<bool>* cancel, AlgInt& ret)
+{
+    //? Small x are found in the sieve primes directly.
+    if (x.get_sign() || AlgInt::cmp(x, 2) < 0)
+    {
+        ret = 2;
+        return true;
+    }
+    if (AlgInt::cmp(x, SIEVE_PRIME_MAX) < 0)
+    {
+        for (uint32_t p : SIEVE_PRIMES)
+        {
+            if (AlgInt::cmp(x, p) < 0)
+            {
+                ret = p;
+                return true;
+            }
+        }
+    }
+
+    // base = the smallest odd number above x
+    AlgInt base, cand;
+    AlgInt::add(x, (x.get_bit(0)) ? 2 : 1, base);
+
+    //* The residues are only computed by division once.
+    std::vector<uint32_t> residues(SIEVE_PRIME_COUNT);
+    for (size_t j = 0; j < SIEVE_PRIME_COUNT; j++)
+        residues[j] = AlgInt::mod(base, SIEVE_PRIMES[j]);
+
+    //? Primary sieve loop (one interval of SIEVE_SPAN odd candidates per iteration)
+    std::vector<bool> composite(SIEVE_SPAN);
+    while (true)
+    {
+        std::fill(composite.begin(), composite.end(), false);
+
+        // base + 2i == 0 (mod p) -> i == -r * 2^-1 (mod p), where 2^-1 == (p+1)/2
+        for (size_t j = 0; j < SIEVE_PRIME_COUNT; j++)
+        {
+            uint32_t p = SIEVE_PRIMES[j];
+            uint32_t r = residues[j];
+            for (uint32_t i = ((p - r) % p) * ((p + 1) / 2) % p; i < SIEVE_SPAN; i += p)
+                composite[i] = true;
+        }
+
+        // Survivors are tested in order, so the first prime found is the next prime.
+        for (uint32_t i = 0; i < SIEVE_SPAN; i++)
+        {
+            if (composite[i])
+                continue;
+            if (cancel && cancel->load(std::memory_order_relaxed))
+                return false;
+
+            AlgInt::add(base, 2*i, cand);
+            if (AlgInt::cmp(cand, (int32_t) SIEVE_LIMIT) < 0 || probable_prime(cand, randfunc, cancel))
+            {
+                std::swap(cand, ret);
+                return true;
+            }
+        }
+
+        //* Move to the next interval, updating the residues without division.
+        AlgInt::add(base, 2*SIEVE_SPAN, base);
+        for (size_t j = 0; j < SIEVE_PRIME_COUNT; j++)
+            residues[j] = (residues[j] + 2*SIEVE_SPAN) % SIEVE_PRIMES[j];
+    }
+}
+
+// ret = a random number of exactly bitsize bits.
+static void random_start(size_t bitsize, uint32_t(*randfunc)(), AlgInt& ret)
+{
+    ret = AlgInt((bitsize + 31) / 32, randfunc);
+    AlgInt::bw_shr(ret, ret.get_size()*32 - bitsize, ret);
+    ret.set_bit(bitsize-1);
+
+    return;
+}
+
+AlgInt AlgInt::next_prime(const AlgInt& x, uint32_t(*randfunc)())
+{
+    AlgInt ret;
+    prime_search(x, randfunc, nullptr, ret);
+
+    return ret;
+}
+
+AlgInt AlgInt::random_prime(size_t bitsize, uint32_t(*randfunc)())
+{
+    //? Exception block
+    if (bitsize < 2)
+        throw std::domain_error("Primes must be at least 2 bits.");
+
+    //* Searches upwards from a random start, until the prime found is still bitsize bits.
+    AlgInt start, prime;
+    while (true)
+    {
+        random_start(bitsize, randfunc, start);
+        prime_search(start, randfunc, nullptr, prime);
+        if (prime.get_bitsize() == bitsize)
+            return prime;
+    }
+}
+
+AlgInt AlgInt::random_prime(size_t bitsize, const std::vector<uint32_t(*)()>& randfuncs)
+{
+    //? Exception block
+    //* The worker threads must never throw, so all inputs are checked up front.
+    if (bitsize < 2)
+        throw std::domain_error("Primes must be at least 2 bits.");
+    if (randfuncs.empty())
+        throw std::domain_error("At least one random function is required.");
+    for (auto randfunc : randfuncs)
+    {
+        if (randfunc == nullptr)
+            throw std::domain_error("Random functions must not be nullptr.");
+    }
+
+    //* The first worker to find a prime claims found, which cancels every other worker.
+    std::atomic<bool> found(false);
+    AlgInt ret;
+
+    auto worker = [&](uint32_t(*randfunc)())
+    {
+        AlgInt start, prime;
+        while (!found.load(std::memory_order_relaxed))
+        {
+            random_start(bitsize, randfunc, start);
+            if (!prime_search(start, randfunc, &found, prime))
+                return;
+            if (prime.get_bitsize() != bitsize)
+                continue;
+
+            bool expected = false;
+            if (found.compare_exchange_strong(expected, true))
+                std::swap(prime, ret);
+            return;
+        }
+    };
+
+    //? One worker per random function (the calling thread runs the first).
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < randfuncs.size(); i++)
+        workers.emplace_back(worker, randfuncs[i]);
+    worker(randfuncs[0]);
+    for (std::thread& thread : workers)
+        thread.join();
+
+    return ret;
+}
+
+// ret = the smallest safe prime 2q+1, where q is at least start and still has the bitsize of start.
+// Returns false (ret is unchanged) if q outgrew the bitsize of start. start must be odd and above SIEVE_PRIME_MAX.
+static bool safe_prime_search(const AlgInt& start, uint32_t(*randfunc)(), AlgInt& ret)
+{
+    size_t q_bits = start.get_bitsize();
+    AlgInt base = start, q, p;
+
+    std::vector<uint32_t> residues(SIEVE_PRIME_COUNT);
+    for (size_t j = 0; j < SIEVE_PRIME_COUNT; j++)
+        residues[j] = AlgInt::mod(base, SIEVE_PRIMES[j]);
+
+    //? Primary double sieve loop (one interval of SIEVE_SPAN odd q per iteration)
+    std::vector<bool> composite(SIEVE_SPAN);
+    while (true)
+    {
+        std::fill(composite.begin(), composite.end(), false);
+
+        //* q is removed if either q or 2q+1 is divisible by p.
+        // q == 0 (mod p)        -> i == -r * 2^-1 (mod p)
+        // 2q+1 == 0 (mod p)     -> i == ((p-1)/2 - r) * 2^-1 (mod p)
+        for (size_t j = 0; j < SIEVE_PRIME_COUNT; j++)
+        {
+            uint32_t p_j = SIEVE_PRIMES[j];
+            uint32_t r = residues[j];
+            uint32_t inv2 = (p_j + 1) / 2;
+            for (uint32_t i = ((p_j - r) % p_j) * inv2 % p_j; i < SIEVE_SPAN; i += p_j)
+                composite[i] = true;
+            for (uint32_t i = ((p_j - 1) / 2 + p_j - r) % p_j * inv2 % p_j; i < SIEVE_SPAN; i += p_j)
+                composite[i] = true;
+        }
+
+        for (uint32_t i = 0; i < SIEVE_SPAN; i++)
+        {
+            if (composite[i])
+                continue;
+
+            AlgInt::add(base, 2*i, q);
+            if (q.get_bitsize() != q_bits)
+                return false;
+            AlgInt::add(q, q, p);
+            AlgInt::add(p, 1, p);
+
+            //* Base 2 rounds on both q and p reject almost every survivor before any further rounds.
+            MillerRabinContext mr_q(q);
+            if (!mr_q.test(2))
+                continue;
+            MillerRabinContext mr_p(p);
+            if (!mr_p.test(2))
+                continue;
+
+            //* Only q needs further rounds: 2^(p-1) == 1 (mod p) and gcd(2^2 - 1, p) == 1 (3 was sieved),
+            //*  so p is prime whenever q is (Pocklington's criterion with p-1 = 2q).
+            if (mr_rounds(mr_q, randfunc, nullptr))
+            {
+                std::swap(p, ret);
+                return true;
+            }
+        }
+
+        //* Move to the next interval, updating the residues without division.
+        AlgInt::add(base, 2*SIEVE_SPAN, base);
+        for (size_t j = 0; j < SIEVE_PRIME_COUNT; j++)
+            residues[j] = (residues[j] + 2*SIEVE_SPAN) % SIEVE_PRIMES[j];
+    }
+}
+
+AlgInt AlgInt::random_safe_prime(size_t bitsize, uint32_t(*randfunc)())
+{
+    //? Exception block
+    if (bitsize < 3)
+        throw std::domain_error("Safe primes must be at least 3 bits.");
+
+    //? Safe primes that fit in 64 bits are found with native integers (q has bitsize-1 bits).
+    if (bitsize <= 64)
+    {
+        uint64_t q_min = 1ULL << (bitsize - 2);
+        while (true)
+        {
+            uint64_t q = (((uint64_t) randfunc() << 32) | randfunc()) & (q_min - 1);
+            for (q |= q_min; q < 2*q_min; q++)
+            {
+                if (is_prime_u64(q) && is_prime_u64(2*q + 1))
+                    return 2*q + 1;
+            }
+        }
+    }
+
+    //* Searches upwards from a random odd q, until the safe prime found is still bitsize bits.
+    AlgInt start, prime;
+    while (true)
+    {
+        random_start(bitsize - 1, randfunc, start);
+        start.set_bit(0);
+        if (safe_prime_search(start, randfunc, prime))
+            return prime;
+    }
+}
@@ -0,0 +1,100 @@
+/**
+*   File: prime_u64.cpp
+*   Project: Alginate
+*   SPDX-License-Identifier: Unlicense
+*
+*   Miller-Rabin with a fixed set of witnesses is deterministic below a known
+*   bound. Every odd composite below 2^64 fails for at least one of the seven
+*   witnesses {2, 325, 9375, 28178, 450775, 9780504, 1795265022} (found by
+*   Jim Sinclair), so these seven rounds decide primality exactly for any
+*   64-bit number. A witness that is a multiple of n proves nothing, and is
+*   skipped.
+*
+*   Numbers below 2^64 fit in a single native word, so the whole test is run
+*   with native integers instead of AlgInts, with no allocation at all. The
+*   squarings use 64-bit Montgomery multiplication: the 128-bit product t is
+*   reduced with q = t_lo * n^-1 (mod 2^64), then t/R = t_hi - (q*n)_hi, which
+*   is corrected by adding n if it underflows. Using n^-1 (instead of -n^-1)
+*   avoids the 129-bit sum t + q*n, so n may use all 64 bits.
+*/
+#include "Alginate.hpp"
+
+// Native 128-bit products (a GCC/Clang extension).
+__extension__ typedef unsigned __int128 uint128_t;
+
+// Deterministic witnesses for all n < 2^64.
+constexpr uint64_t U64_WITNESSES[] = {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+
+// a * b * R^-1 (mod n), where a, b < n and n_inv = n^-1 (mod 2^64).
+static inline uint64_t mont_mul_u64(uint64_t a, uint64_t b, uint64_t n, uint64_t n_inv)
+{
+    uint128_t t = (uint128_t) a * b;
+    uint64_t q = (uint64_t) t * n_inv;
+    uint64_t qn_hi = ((uint128_t) q * n) >> 64;
+    uint64_t t_hi = t >> 64;
+
+    //* t - q*n is divisible by R, and t_hi - qn_hi is within (-n, n).
+    return (t_hi < qn_hi) ? t_hi - qn_hi + n : t_hi - qn_hi;
+}
+
+bool AlgInt::is_prime_u64(uint64_t n)
+{
+    //? Small and even n
+    if (n < 2)
+        return false;
+    if ((n & 1) == 0)
+        return n == 2;
+    if (n < 9)
+        return n != 1;
+
+    //? Montgomery setup (R = 2^64)
+    uint64_t n_inv = inv_u64(n);                       // n^-1 (mod 2^64)
+
+    uint64_t one = -n % n;                             // R (mod n)
+    uint64_t r2 = ((uint128_t) one * one) % n;         // R^2 (mod n)
+    uint64_t minus_one = n - one;                      // -R (mod n)
+
+    // n - 1 = d << s
+    uint64_t d = n - 1;
+    size_t s = 0;
+    while ((d & 1) == 0)
+    {
+        d >>= 1;
+        s++;
+    }
+
+    //? Miller-Rabin for every witness
+    for (uint64_t witness : U64_WITNESSES)
+    {
+        uint64_t a = witness % n;
+        if (a == 0)
+            continue;
+
+        // x = a^d (mod n) in Montgomery space (right to left).
+        uint64_t sqr = mont_mul_u64(a, r2, n, n_inv);
+        uint64_t x = one;
+        for (uint64_t e = d; e; e >>= 1)
+        {
+            if (e & 1)
+                x = mont_mul_u64(x, sqr, n, n_inv);
+            sqr = mont_mul_u64(sqr, sqr, n, n_inv);
+        }
+
+        if (x == one || x == minus_one)
+            continue;
+
+        // x^(2^r) == -1 for any r in [1, s)
+        bool probable = false;
+        for (size_t r = 1; r < s && !probable; r++)
+        {
+            x = mont_mul_u64(x, x, n, n_inv);
+            probable = (x == minus_one);
+        }
+
+        //* This witness proves n composite.
+        if (!probable)
+            return false;
+    }
+
+    return true;
+}
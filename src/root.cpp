@@ -0,0 +1,200 @@
+/**
+*   File: root.cpp
+*   Project: Alginate
+*   SPDX-License-Identifier: Unlicense
+*
+*   Integer roots are found with Newton's iteration. For the k-th root of x,
+*   one step from r is
+*
+*       r' = ((k-1)*r + x / r^(k-1)) / k
+*
+*   and an integer step (with floor divisions) that starts above floor(x^(1/k))
+*   decreases monotonically until it reaches it. Each step doubles the number
+*   of correct bits, so a good first approximation matters more than anything.
+*
+*   The approximation is found recursively, at half the precision: the root s
+*   of x >> k*h (the leading bits of x) gives (s+1) << h, an upper bound of the
+*   root of x whose leading half is already correct. The recursion ends at x
+*   below 2^64, where the root is computed natively (seeding the whole chain
+*   from the leading 64 bits of x). Every level costs a constant number of
+*   operations at its own precision, so the final level dominates the cost.
+*
+*   For square roots, h is chosen so that a single step from (s+1) << h is off
+*   by at most one. The remainder x - r^2 is then computed (which is also
+*   returned by isqrt_rem()), and fixes r with a comparison instead of a
+*   confirming Newton step (a full division).
+*/
+#include "Alginate.hpp"
+#include <cmath>
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+// Returns true if r^k <= x, without overflow.
+static bool pow_leq(uint64_t r, uint32_t k, uint64_t x)
+{
+    //* 0^k and 1^k never exceed x (k >= 1), and would otherwise take k steps.
+    if (r <= 1)
+        return r <= x;
+
+    uint128_t pow = 1;
+    for (uint32_t i = 0; i < k; i++)
+    {
+        pow *= r;
+        if (pow > x)
+            return false;
+    }
+
+    return true;
+}
+
+// Returns floor(x^(1/k)) for a native x.
+static uint64_t iroot_u64(uint64_t x, uint32_t k)
+{
+    //* The floating point estimate is corrected in both directions.
+    uint64_t r = (uint64_t) std::pow((long double) x, 1.0L / k);
+    while (r && !pow_leq(r, k, x))
+        r--;
+    while (pow_leq(r + 1, k, x))
+        r++;
+
+    return r;
+}
+
+void AlgInt::isqrt_rem(const AlgInt& x, AlgInt& root, AlgInt& rem)
+{
+    //? Exception block
+    if (x.sign)
+        throw std::domain_error("Square root of a negative number.");
+
+    size_t bits = x.get_bitsize();
+    AlgInt troot, trem;
+
+    if (bits <= 64)
+    {
+        //? Native root
+        uint64_t x_u64 = x.output_uint64();
+        uint64_t r = iroot_u64(x_u64, 2);
+        troot = r;
+        trem = x_u64 - r*r;
+    }
+    else
+    {
+        //? Leading half of the root, from the leading half of x.
+        //* A single step from (s+1) << h is off by at most one if h < bits/4.
+        size_t h = bits / 4 - 1;
+        AlgInt lead, temp;
+        bw_shr(x, 2*h, lead);
+        isqrt_rem(lead, troot, temp);
+        add(troot, 1, troot);
+        bw_shl(troot, h, troot);
+
+        //* r = (r + x/r) / 2
+        div(x, troot, temp);
+        add(troot, temp, troot);
+        bw_shr(troot, 1, troot);
+
+        //? Remainder, which corrects r by one in either direction.
+        mul(troot, troot, temp);
+        sub(x, temp, trem);
+        while (trem.sign)
+        {
+            // (r-1)^2 = r^2 - 2r + 1
+            bw_shl(troot, 1, temp);
+            sub(temp, 1, temp);
+            add(trem, temp, trem);
+            sub(troot, 1, troot);
+        }
+        bw_shl(troot, 1, temp);
+        while (cmp(trem, temp) > 0)
+        {
+            // (r+1)^2 = r^2 + 2r + 1
+            add(temp, 1, temp);
+            sub(trem, temp, trem);
+            add(troot, 1, troot);
+            bw_shl(troot, 1, temp);
+        }
+    }
+
+    // Return values
+    swap(troot, root);
+    swap(trem, rem);
+    return;
+}
+
+void AlgInt::isqrt(const AlgInt& x, AlgInt& ret)
+{
+    AlgInt rem;
+    isqrt_rem(x, ret, rem);
+
+    return;
+}
+
+void AlgInt::iroot(const AlgInt& x, uint32_t k, AlgInt& ret)
+{
+    //? Exception block
+    if (k == 0)
+        throw std::domain_error("0th root is undefined.");
+    if (x.sign && (k & 1) == 0)
+        throw std::domain_error("Even root of a negative number.");
+
+    if (k == 1)
+        return (void) (ret = x);
+    if (k == 2 && !x.sign)
+        return isqrt(x, ret);
+
+    //* Odd roots of negative numbers are rounded toward zero.
+    AlgInt abs_x = x, troot;
+    abs_x.sign = false;
+
+    size_t bits = abs_x.get_bitsize();
+    size_t root_bits = (bits + k - 1) / k;
+    if (k >= bits)
+    {
+        //? |x| < 2^k, so the root is 1 (or 0 for x == 0).
+        troot = (bits) ? 1 : 0;
+    }
+    else if (bits <= 64)
+    {
+        //? Native root
+        troot = iroot_u64(abs_x.output_uint64(), k);
+    }
+    else
+    {
+        //? Upper bound from the leading half of the root (or 2^root_bits for tiny roots).
+        size_t h = (root_bits > 2) ? root_bits / 2 - 1 : 0;
+        if (h)
+        {
+            AlgInt lead;
+            bw_shr(abs_x, (size_t) k * h, lead);
+            iroot(lead, k, troot);
+            add(troot, 1, troot);
+            bw_shl(troot, h, troot);
+        }
+        else
+        {
+            troot = 1;
+            bw_shl(troot, root_bits, troot);
+        }
+
+        //? Newton steps from above, until the root stops decreasing.
+        AlgInt next, pow, exponent = k - 1;
+        while (true)
+        {
+            // r' = ((k-1)*r + x / r^(k-1)) / k
+            exp(troot, exponent, pow);
+            div(abs_x, pow, next);
+            mul(troot, k - 1, pow);
+            add(next, pow, next);
+            div(next, k, next);
+
+            if (cmp(next, troot) >= 0)
+                break;
+            swap(troot, next);
+        }
+    }
+
+    // Return values
+    troot.sign = x.sign && troot.size;
+    swap(troot, ret);
+    return;
+}
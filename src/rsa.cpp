@@ -0,0 +1,240 @@
+/**
+*   File: rsa.cpp
+*   Project: Alginate
+*   SPDX-License-Identifier: Unlicense
+*
+*   The RSA private operation x^d (mod n) is the most expensive operation in
+*   RSA, because d is as long as n. Knowing the factors n = p*q allows the
+*   exponentiation to be split by the Chinese Remainder Theorem (CRT) into
+*   m1 = x^dp (mod p) and m2 = x^dq (mod q), where dp = d mod (p-1) and
+*   dq = d mod (q-1) (Fermat's little theorem). Each half has a modulus and an
+*   exponent of half the length, and exponentiation costs roughly the cube of
+*   the length, so both halves together cost about a quarter of the full one.
+*
+*   The halves are recombined with Garner's formula: h = q_inv*(m1 - m2) mod p,
+*   x^d = m2 + h*q, where q_inv = q^-1 (mod p). This requires only a single
+*   multiplication and reduction mod p, with no reduction mod n.
+*
+*   The two halves are completely independent, so they may optionally be run
+*   concurrently. The q half is run on a second thread while the calling thread
+*   computes the p half, which roughly halves the latency of a single operation.
+*
+*   Multi-prime RSA (RFC 8017) extends this to n = r_0 * r_1 * ... * r_(u-1).
+*   Each exponentiation shrinks to 1/u of the length, so the private operation
+*   costs about u^2 times less than the full exponentiation (instead of 4 times).
+*   Garner's formula is applied once per additional prime: with R the product of
+*   the previous primes and m the result so far (mod R), the next prime r_i is
+*   folded in with h = (m_i - m) * t_i mod r_i, m = m + R*h, where t_i = R^-1
+*   (mod r_i) is precomputed in the key.
+*/
+#include "Alginate.hpp"
+#include <thread>
+
+// ret = a random prime of exactly bitsize bits (top two bits set), where gcd(e, ret-1) == 1.
+static void rsa_prime(size_t bitsize, uint32_t(*randfunc)(), const AlgInt& e, AlgInt& ret)
+{
+    AlgInt start, temp;
+
+    while (true)
+    {
+        // Random start, cut down to bitsize bits.
+        start = AlgInt((bitsize + 31) / 32, randfunc);
+        AlgInt::bw_shr(start, start.get_size()*32 - bitsize, start);
+        start.set_bit(bitsize-1);
+        start.set_bit(bitsize-2);
+
+        ret = AlgInt::next_prime(start, randfunc);
+        if (ret.get_bitsize() != bitsize)
+            continue;
+
+        // e must be invertible mod (ret - 1).
+        AlgInt::sub(ret, 1, temp);
+        AlgInt::gcd(e, temp, temp);
+        if (temp == 1)
+            return;
+    }
+}
+
+// ret = x^d (mod p), where x is first reduced mod p.
+static void crt_half(const AlgInt& x, const AlgInt& p, const AlgInt& d, AlgInt& ret)
+{
+    AlgInt temp;
+    AlgInt::mod(x, p, temp);
+    AlgInt::mod_exp(temp, d, p, ret);
+
+    return;
+}
+
+void AlgInt::rsa_crt(const AlgInt& x, const AlgInt& p, const AlgInt& q, const AlgInt& dp, const AlgInt& dq, const AlgInt& q_inv, AlgInt& ret, bool threaded)
+{
+    //? Exception block
+    //* The worker thread must never throw, so all inputs are checked up front.
+    if (x.sign || p.sign || q.sign || dp.sign || dq.sign || q_inv.sign)
+        throw std::domain_error("Signed RSA parameters not supported.");
+    if (p.size == 0 || q.size == 0)
+        throw std::domain_error("p and q must be non-zero.");
+
+    AlgInt m1, m2;
+
+    //? Exponentiate both halves (m1 = x^dp mod p, m2 = x^dq mod q)
+    if (threaded)
+    {
+        std::thread worker(crt_half, std::cref(x), std::cref(q), std::cref(dq), std::ref(m2));
+        crt_half(x, p, dp, m1);
+        worker.join();
+    }
+    else
+    {
+        crt_half(x, p, dp, m1);
+        crt_half(x, q, dq, m2);
+    }
+
+    //? Garner recombination
+    // h = q_inv * (m1 - m2) (mod p), kept positive.
+    AlgInt h;
+    mod(m2, p, h);
+    sub(m1, h, h);
+    if (h.sign)
+        add(h, p, h);
+    mod_mul(h, q_inv, p, h);
+
+    // ret = m2 + h*q
+    mul(h, q, h);
+    add(h, m2, ret);
+
+    return;
+}
+
+void AlgInt::rsa_keygen(size_t bitsize, size_t prime_count, uint32_t(*randfunc)(), RSAKey& key)
+{
+    //? Exception block
+    if (prime_count < 2)
+        throw std::domain_error("RSA requires at least two primes.");
+    if (bitsize < 64*prime_count)
+        throw std::domain_error("Each RSA prime must be at least 64 bits.");
+
+    RSAKey tkey;
+    tkey.e = 65537;
+    tkey.primes.resize(prime_count);
+
+    //? Prime generation
+    //* Earlier primes take the remaining bits, so the sizes sum to bitsize. The
+    //*  product may still fall one bit short, in which case every prime is redrawn.
+    do
+    {
+        for (size_t i = 0; i < prime_count; i++)
+        {
+            size_t prime_bits = bitsize / prime_count + (i < bitsize % prime_count);
+            AlgInt& r = tkey.primes[i];
+
+            // All primes must be distinct.
+            bool distinct = false;
+            while (!distinct)
+            {
+                rsa_prime(prime_bits, randfunc, tkey.e, r);
+                distinct = true;
+                for (size_t j = 0; j < i; j++)
+                    distinct &= (r != tkey.primes[j]);
+            }
+        }
+
+        tkey.n = tkey.primes[0];
+        for (size_t i = 1; i < prime_count; i++)
+            mul(tkey.n, tkey.primes[i], tkey.n);
+    } while (tkey.n.get_bitsize() != bitsize);
+
+    //? Private exponent d = e^-1 (mod lcm(r_i - 1))
+    AlgInt lambda = 1, temp;
+    for (const AlgInt& r : tkey.primes)
+    {
+        sub(r, 1, temp);
+        lambda = lcm(lambda, temp);
+    }
+    mod_inv(tkey.e, lambda, tkey.d);
+
+    //? CRT exponents and coefficients
+    //* coeffs[i] = (r_0 * ... * r_(i-1))^-1 (mod r_i), coeffs[1] is q^-1 (mod p) from rsa_crt().
+    tkey.exps.resize(prime_count);
+    tkey.coeffs.resize(prime_count);
+    AlgInt prefix = tkey.primes[0];
+    for (size_t i = 0; i < prime_count; i++)
+    {
+        sub(tkey.primes[i], 1, temp);
+        mod(tkey.d, temp, tkey.exps[i]);
+    }
+    mod_inv(tkey.primes[1], tkey.primes[0], tkey.coeffs[1]);
+    for (size_t i = 2; i < prime_count; i++)
+    {
+        mul(prefix, tkey.primes[i-1], prefix);
+        mod_inv(prefix, tkey.primes[i], tkey.coeffs[i]);
+    }
+
+    // Return values
+    std::swap(key, tkey);
+    return;
+}
+
+void AlgInt::rsa_private(const AlgInt& x, const RSAKey& key, AlgInt& ret, bool threaded)
+{
+    //? Exception block
+    //* The worker threads must never throw, so all inputs are checked up front.
+    size_t count = key.primes.size();
+    if (count < 2 || key.exps.size() != count || key.coeffs.size() != count)
+        throw std::domain_error("RSA key must contain at least two primes, with matching exponents and coefficients.");
+    if (x.sign)
+        throw std::domain_error("Signed x not supported.");
+    for (const AlgInt& r : key.primes)
+    {
+        if (r.sign || r.size == 0)
+            throw std::domain_error("RSA primes must be positive.");
+    }
+
+    //? Exponentiate every prime (m_i = x^d_i mod r_i)
+    std::vector<AlgInt> m(count);
+    if (threaded)
+    {
+        //* The calling thread takes the first prime.
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < count; i++)
+            workers.emplace_back(crt_half, std::cref(x), std::cref(key.primes[i]), std::cref(key.exps[i]), std::ref(m[i]));
+        crt_half(x, key.primes[0], key.exps[0], m[0]);
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+    else
+    {
+        for (size_t i = 0; i < count; i++)
+            crt_half(x, key.primes[i], key.exps[i], m[i]);
+    }
+
+    //? Garner recombination (m_1, then m_0, then m_2 ... m_(u-1))
+    // The first two primes match rsa_crt(): h = q_inv * (m_0 - m_1) (mod p), res = m_1 + h*q
+    AlgInt res, h, prefix;
+    mod(m[1], key.primes[0], h);
+    sub(m[0], h, h);
+    if (h.sign)
+        add(h, key.primes[0], h);
+    mod_mul(h, key.coeffs[1], key.primes[0], h);
+    mul(h, key.primes[1], h);
+    add(h, m[1], res);
+
+    // Every other prime: h = t_i * (m_i - res) (mod r_i), res = res + h*R
+    prefix = key.primes[0];
+    for (size_t i = 2; i < count; i++)
+    {
+        const AlgInt& r = key.primes[i];
+        mul(prefix, key.primes[i-1], prefix);
+
+        mod(res, r, h);
+        sub(m[i], h, h);
+        if (h.sign)
+            add(h, r, h);
+        mod_mul(h, key.coeffs[i], r, h);
+        mul(h, prefix, h);
+        add(res, h, res);
+    }
+
+    // Return values
+    swap(res, ret);
+    return;
+}
@@ -0,0 +1,219 @@
+/**
+*   File: special_mod.cpp
+*   Project: Alginate
+*   SPDX-License-Identifier: Unlicense
+*
+*   Many moduli used in cryptography sit just below a power of two. These
+*   moduli can be written as m = 2^k - c, where c is much smaller than m.
+*   Because 2^k == c (mod m), any x can be split at bit k into hi and lo
+*   (x = hi*2^k + lo) and then folded into x == hi*c + lo (mod m). Each fold
+*   removes (k - bitsize(c)) bits from x, so a product of two reduced values
+*   is brought below 2^k after only a few folds. A single subtraction of m
+*   finishes the reduction. No division is performed at any point.
+*
+*   Mersenne moduli (c == 1) fold with a single addition. Pseudo-Mersenne
+*   moduli (small c) fold with one short multiplication. Solinas moduli have
+*   a c that is a sparse sum of signed powers of two (such as the NIST primes),
+*   so hi*c is computed as a handful of shifts and additions. The sparse form
+*   is found with the non-adjacent form (NAF) of c, which has the fewest
+*   non-zero signed digits of any binary representation.
+*
+*   Classification is cheap to reject: any m of this shape has a leading
+*   digit of the form 2^j - 1, which random moduli almost never have. A
+*   successful classification still costs a subtraction and the NAF of c, so
+*   chained products (such as mod_exp()) classify once and keep the
+*   SpecialMod, and plain mod() never classifies at all.
+*/
+#include "Alginate.hpp"
+
+// Solinas moduli are only used if c has at most this many NAF digits.
+constexpr size_t SOLINAS_MAX_TERMS = 8;
+
+// acc += x << shift, where acc has enough digits to hold the result.
+static void shift_add(uint32_t* acc, const uint32_t* x, size_t x_size, size_t shift)
+{
+    size_t dig_shift = shift >> 5;
+    size_t bit_shift = shift & 0x1F;
+
+    //* carry holds both the addition carry and the bits shifted out of the previous digit.
+    uint64_t carry = 0;
+    size_t i;
+    for (i = 0; i < x_size; i++)
+    {
+        uint64_t shifted = (uint64_t) x[i] << bit_shift;
+        carry += (uint64_t) acc[dig_shift + i] + (uint32_t) shifted;
+        acc[dig_shift + i] = (uint32_t) carry;
+        carry = (carry >> 32) + (shifted >> 32);
+    }
+
+    // Final carry propagation
+    for (i += dig_shift; carry; i++)
+    {
+        carry += acc[i];
+        acc[i] = (uint32_t) carry;
+        carry >>= 32;
+    }
+
+    return;
+}
+
+bool AlgInt::special_mod(const AlgInt& m, SpecialMod& sm)
+{
+    sm.form = ModForm::General;
+
+    //* Quick rejection: the MSW of 2^k - c (for small c) is all ones below its top bit.
+    if (m.sign || m.size < 2)
+        return false;
+    uint32_t msw = m.num[m.size-1];
+    if (msw & (msw + 1))
+        return false;
+
+    // c = 2^k - m
+    sm.k = m.get_bitsize();
+    AlgInt pow2;
+    pow2.set_bit(sm.k);
+    sub(pow2, m, sm.c);
+    sm.terms.clear();
+
+    size_t c_bits = sm.c.get_bitsize();
+    if (cmp(sm.c, 1) == 0)
+        sm.form = ModForm::Mersenne;
+    else if (sm.c.size == 1 && c_bits <= sm.k/2)
+        sm.form = ModForm::PseudoMersenne;
+    else
+    {
+        //? Non-adjacent form of c (least significant digit first)
+        //* Each odd (c + carry) produces a digit of +1 or -1, chosen so the
+        //*  following digit is always zero.
+        bool carry = 0;
+        for (size_t i = 0; i <= c_bits && sm.terms.size() <= SOLINAS_MAX_TERMS; i++)
+        {
+            uint8_t digit = sm.c.get_bit(i) + carry;
+            if (digit == 1)
+            {
+                // c mod 4 == 3 -> -1 (with carry), c mod 4 == 1 -> +1
+                carry = sm.c.get_bit(i+1);
+                sm.terms.push_back({i, carry});
+            }
+            else
+                carry = (digit == 2);
+        }
+
+        //* Like pseudo-Mersenne moduli, c must fit in k/2 bits so that a product
+        //*  only requires two or three folds (P-384 qualifies, P-256 does not).
+        size_t top = (sm.terms.size()) ? sm.terms.back().first + 1 : sm.k;
+        if (sm.terms.size() <= SOLINAS_MAX_TERMS && top <= sm.k/2)
+            sm.form = ModForm::Solinas;
+        else if (c_bits <= sm.k/2)
+            sm.form = ModForm::PseudoMersenne;
+    }
+
+    if (sm.form == ModForm::General)
+        return false;
+
+    sm.m = m;
+    return true;
+}
+
+void AlgInt::special_redc(AlgInt& x, const SpecialMod& sm)
+{
+    // Number of digits (and bits in the final digit) below 2^k.
+    size_t k_digits = (sm.k + 31) / 32;
+    uint32_t k_mask = (sm.k & 0x1F) ? (1UL << (sm.k & 0x1F)) - 1 : UINT32_MAX;
+
+    //? Primary folding loop (x = hi*2^k + lo -> hi*c + lo)
+    AlgInt hi, pos, neg;
+    while (x.size && x.get_bitsize() > sm.k)
+    {
+        bw_shr(x, sm.k, hi);
+
+        //* lo = x & (2^k - 1), performed in place.
+        x.resize(k_digits);
+        x.num[k_digits-1] &= k_mask;
+        x.trunc();
+
+        switch (sm.form)
+        {
+            case ModForm::Mersenne:
+                break;
+
+            case ModForm::PseudoMersenne:
+                if (sm.c.size == 1)
+                    mul(hi, sm.c.num[0], hi);
+                else
+                    mul(hi, sm.c, hi);
+                break;
+
+            case ModForm::Solinas:
+                //* hi*c as a signed sum of shifted copies of hi. The positive and
+                //*  negative terms are accumulated separately, directly into digits.
+                //*  Resizing through zero clears the digits without reallocating.
+                pos.resize(0);
+                neg.resize(0);
+                pos.resize(hi.size + sm.k/32 + 2);
+                neg.resize(hi.size + sm.k/32 + 2);
+                for (const auto& term : sm.terms)
+                    shift_add((term.second) ? neg.num : pos.num, hi.num, hi.size, term.first);
+                pos.trunc();
+                neg.trunc();
+
+                // x + hi*c == x + pos - neg, where pos > neg
+                add(x, pos, x);
+                sub(x, neg, x);
+                continue;
+
+            case ModForm::General:
+                throw std::domain_error("General moduli cannot be reduced by folding.");
+        }
+
+        add(x, hi, x);
+    }
+
+    //* x < 2^k < 2m, so at most one subtraction remains.
+    if (cmp(x, sm.m) >= 0)
+        sub(x, sm.m, x);
+
+    return;
+}
+
+AlgInt::ModForm AlgInt::classify_mod(const AlgInt& m)
+{
+    SpecialMod sm;
+    special_mod(m, sm);
+
+    return sm.form;
+}
+
+void AlgInt::mod_mul(const AlgInt& x, const AlgInt& y, const AlgInt& m, AlgInt& ret)
+{
+    //* The leading digit rejects general moduli before any classification work.
+    SpecialMod sm;
+    if (special_mod(m, sm))
+        return mod_mul(x, y, sm, ret);
+
+    AlgInt temp;
+    mul(x, y, temp);
+    mod(temp, m, ret);
+
+    return;
+}
+
+void AlgInt::mod_mul(const AlgInt& x, const AlgInt& y, const SpecialMod& sm, AlgInt& ret)
+{
+    //? Exception block
+    if (sm.form == ModForm::General)
+        throw std::domain_error("General moduli cannot be reduced by folding.");
+
+    AlgInt temp;
+    mul(x, y, temp);
+
+    //* Folding requires a non-negative product.
+    if (temp.sign)
+        mod(temp, sm.m, temp);
+    else
+        special_redc(temp, sm);
+
+    // Return values
+    swap(temp, ret);
+    return;
+}